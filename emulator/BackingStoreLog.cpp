@@ -0,0 +1,151 @@
+#include "BackingStoreLog.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Out-of-line definition: memcpy/memcmp take its address
+constexpr char BackingStoreLog::MAGIC[4];
+
+BackingStoreLog::BackingStoreLog(const std::string& path, int wordsPerPage, SyncPolicy sync)
+    : path_(path), wordsPerPage_(wordsPerPage), sync_(sync), queue_(QUEUE_CAPACITY) {
+#ifdef _WIN32
+    if (fopen_s(&file_, path_.c_str(), "wb") != 0) file_ = nullptr;
+#else
+    file_ = std::fopen(path_.c_str(), "wb");
+#endif
+    if (!file_) {
+        std::cerr << "Error: Could not open " << path_ << " for writing." << std::endl;
+    }
+    else {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.wordsPerPage = static_cast<uint32_t>(wordsPerPage_);
+        std::fwrite(&header, sizeof(header), 1, file_);
+        std::fflush(file_);
+    }
+    writer_ = std::thread(&BackingStoreLog::writerLoop, this);
+}
+
+BackingStoreLog::~BackingStoreLog() {
+    Record stop{};
+    stop.header.pid = STOP_PID;
+    queue_.push(std::move(stop));
+    writer_.join();
+    if (file_) std::fclose(file_);
+}
+
+void BackingStoreLog::append(Record record) {
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        ++appended_;
+    }
+    queue_.push(std::move(record));
+}
+
+void BackingStoreLog::flush() {
+    std::unique_lock<std::mutex> lock(progressMutex_);
+    uint64_t target = appended_;
+    progressCv_.wait(lock, [&]() { return written_ >= target; });
+}
+
+uint64_t BackingStoreLog::getRecordsWritten() const {
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    return written_;
+}
+
+void BackingStoreLog::writerLoop() {
+    const size_t batchLimit = sync_ == SyncPolicy::ALWAYS ? 1 : MAX_BATCH;
+    std::vector<Record> batch;
+    batch.reserve(batchLimit);
+
+    bool stopping = false;
+    while (!stopping) {
+        // Sleep until there is work, then take whatever else is already queued
+        Record record = queue_.pop();
+        do {
+            if (record.header.pid == STOP_PID) {
+                stopping = true;
+                break;
+            }
+            batch.push_back(std::move(record));
+        } while (batch.size() < batchLimit && queue_.try_pop(record));
+
+        if (!batch.empty()) writeBatch(batch);
+    }
+}
+
+void BackingStoreLog::writeBatch(std::vector<Record>& batch) {
+    const size_t dataBytes = static_cast<size_t>(wordsPerPage_) * sizeof(uint16_t);
+    const size_t recordBytes = sizeof(RecordHeader) + dataBytes;
+
+    if (file_) {
+        buffer_.assign(batch.size() * recordBytes, 0);
+        char* out = buffer_.data();
+        for (Record& r : batch) {
+            std::memcpy(out, &r.header, sizeof(RecordHeader));
+            size_t words = std::min(r.data.size(), static_cast<size_t>(wordsPerPage_));
+            std::memcpy(out + sizeof(RecordHeader), r.data.data(), words * sizeof(uint16_t));
+            out += recordBytes;
+        }
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        std::fflush(file_);
+        if (sync_ != SyncPolicy::NEVER) syncFile();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        written_ += batch.size();
+    }
+    progressCv_.notify_all();
+    batch.clear();
+}
+
+void BackingStoreLog::syncFile() {
+#ifdef _WIN32
+    _commit(_fileno(file_));
+#else
+    fsync(fileno(file_));
+#endif
+}
+
+bool BackingStoreLog::readAll(const std::string& path, int& wordsPerPage, std::vector<Record>& records) {
+    FILE* in = nullptr;
+#ifdef _WIN32
+    if (fopen_s(&in, path.c_str(), "rb") != 0) in = nullptr;
+#else
+    in = std::fopen(path.c_str(), "rb");
+#endif
+    if (!in) return false;
+
+    FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, in) != 1 ||
+        std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+        std::fclose(in);
+        return false;
+    }
+    wordsPerPage = static_cast<int>(header.wordsPerPage);
+
+    Record r;
+    while (std::fread(&r.header, sizeof(RecordHeader), 1, in) == 1) {
+        r.data.assign(header.wordsPerPage, 0);
+        // A record cut short by a crash mid-write is dropped
+        if (std::fread(r.data.data(), sizeof(uint16_t), r.data.size(), in) != r.data.size()) break;
+        records.push_back(r);
+    }
+    std::fclose(in);
+    return true;
+}
+
+bool BackingStoreLog::parseSyncPolicy(const std::string& name, SyncPolicy& out) {
+    if (name == "never") out = SyncPolicy::NEVER;
+    else if (name == "batch") out = SyncPolicy::BATCH;
+    else if (name == "always") out = SyncPolicy::ALWAYS;
+    else return false;
+    return true;
+}
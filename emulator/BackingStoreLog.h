@@ -0,0 +1,91 @@
+// BackingStoreLog.h
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MPMCQueue.h"
+
+// Append-only binary log of dirty page evictions. Evicting threads only enqueue a record;
+// a background writer drains the bounded queue and appends whole batches to a file that
+// is opened (and truncated) once, when the log is created. The file starts with a
+// FileHeader followed by fixed-size records: a RecordHeader and then wordsPerPage words.
+class BackingStoreLog {
+public:
+    enum class SyncPolicy {
+        NEVER,  // Leave flushing to the OS
+        BATCH,  // fsync after every batch written
+        ALWAYS  // Write and fsync every record on its own
+    };
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t wordsPerPage;
+        uint32_t reserved;
+    };
+
+    struct RecordHeader {
+        int64_t evictedAt;      // time_t
+        uint64_t pid;
+        int32_t page;
+        int32_t frame;
+        uint32_t variableCount; // Declared variables at eviction, for page 0's symbol table
+        uint32_t reserved;
+    };
+
+    struct Record {
+        RecordHeader header;
+        std::vector<uint16_t> data;
+    };
+
+    static constexpr char MAGIC[4] = { 'C', 'S', 'B', 'S' };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr size_t MAX_BATCH = 64;
+
+    BackingStoreLog(const std::string& path, int wordsPerPage, SyncPolicy sync = SyncPolicy::NEVER);
+    ~BackingStoreLog();
+
+    BackingStoreLog(const BackingStoreLog&) = delete;
+    BackingStoreLog& operator=(const BackingStoreLog&) = delete;
+
+    // Queues a record for the writer; blocks only while the queue is full
+    void append(Record record);
+    // Waits until everything appended so far has reached the file
+    void flush();
+
+    const std::string& getPath() const { return path_; }
+    uint64_t getRecordsWritten() const;
+
+    // Reads back a log written by this class; false if the file is missing or not a log
+    static bool readAll(const std::string& path, int& wordsPerPage, std::vector<Record>& records);
+
+    // "never", "batch" or "always"
+    static bool parseSyncPolicy(const std::string& name, SyncPolicy& out);
+
+private:
+    void writerLoop();
+    void writeBatch(std::vector<Record>& batch);
+    void syncFile();
+
+    std::string path_;
+    int wordsPerPage_;
+    SyncPolicy sync_;
+    FILE* file_ = nullptr;
+    std::vector<char> buffer_; // Serialized batch, reused between writes
+
+    MPMCQueue<Record> queue_;
+    std::thread writer_;
+
+    // Progress, for flush(); the stop request is a record with pid STOP_PID
+    static constexpr uint64_t STOP_PID = UINT64_MAX;
+    mutable std::mutex progressMutex_;
+    std::condition_variable progressCv_;
+    uint64_t appended_ = 0;
+    uint64_t written_ = 0;
+};
@@ -0,0 +1,256 @@
+#include "Benchmark.h"
+#include "ThreadedQueue.h"
+#include "MPMCQueue.h"
+#include "ReplacementPolicy.h"
+#include "Process.h"
+#include "MainMemory.h"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const int THREAD_COUNTS[] = { 1, 2, 4, 8, 16, 32, 64 };
+    const int ITEMS_PER_PRODUCER = 20000;
+
+    // Runs `threads` producers and `threads` consumers through the queue and
+    // returns completed push/pop pairs per second.
+    template <typename Queue>
+    double measureQueue(int threads) {
+        Queue queue;
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(threads) * 2);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&queue]() {
+                for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                    queue.push(std::make_shared<int>(i));
+                }
+                });
+            workers.emplace_back([&queue]() {
+                for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                    std::shared_ptr<int> item = queue.pop();
+                    (void)item;
+                }
+                });
+        }
+        for (auto& w : workers) w.join();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double ops = static_cast<double>(threads) * ITEMS_PER_PRODUCER;
+        return elapsed > 0 ? ops / elapsed : 0.0;
+    }
+
+    const int MEMORY_FRAMES = 1024;
+    const int MEMORY_FRAME_SIZE = 16;
+    const int MEMORY_OPS_PER_THREAD = 200000;
+
+    // Runs `threads` cores' worth of alternating reads and writes against MainMemory, each
+    // thread in its own frames (frame % threads == thread), and returns operations per second.
+    double measureMemory(int lockStripes, int threads) {
+        MainMemory memory(MEMORY_FRAMES * MEMORY_FRAME_SIZE, MEMORY_FRAME_SIZE, lockStripes);
+        std::atomic<uint32_t> sink{ 0 };
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&memory, &sink, t, threads]() {
+                uint32_t state = 2463534242u + static_cast<uint32_t>(t);
+                uint32_t sum = 0;
+                int framesOwned = MEMORY_FRAMES / threads;
+                for (int i = 0; i < MEMORY_OPS_PER_THREAD; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    int frame = static_cast<int>(state % framesOwned) * threads + t;
+                    int addr = frame * MEMORY_FRAME_SIZE + static_cast<int>((state >> 8) % (MEMORY_FRAME_SIZE / 2)) * 2;
+                    if (i & 1) memory.write(addr, static_cast<uint16_t>(i));
+                    else sum += memory.read(addr);
+                }
+                sink.fetch_add(sum, std::memory_order_relaxed);
+                });
+        }
+        for (auto& w : workers) w.join();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double ops = static_cast<double>(threads) * MEMORY_OPS_PER_THREAD;
+        return elapsed > 0 ? ops / elapsed : 0.0;
+    }
+
+    const char* const POLICY_NAMES[] = { "fifo", "clock", "lru", "wsclock" };
+    const int PAGING_FRAMES = 64;
+    const int PAGING_PROCESSES = 8;
+    const int PAGES_PER_PROCESS = 24;
+    const int PAGING_ACCESSES = 400000;
+    const int ACCESSES_PER_QUANTUM = 50;
+    const uint64_t PAGING_WS_WINDOW = 1000; // in accesses, the benchmark's clock
+
+    struct PageRef {
+        int page; // process * PAGES_PER_PROCESS + page number
+        bool write;
+    };
+
+    // Loop-heavy reference string shaped like the emulator's processes: round-robin quanta,
+    // a hot page 0 (the symbol table), a small loop body that moves now and then, and
+    // occasional scattered accesses. Seeded, so every policy sees the same trace.
+    std::vector<PageRef> makePagingWorkload() {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        std::uniform_int_distribution<int> anyPage(0, PAGES_PER_PROCESS - 1);
+        std::uniform_int_distribution<int> loopOffset(0, 3);
+
+        std::vector<int> loopBase(PAGING_PROCESSES);
+        for (int& base : loopBase) base = 1 + anyPage(gen) % (PAGES_PER_PROCESS - 4);
+
+        std::vector<PageRef> refs;
+        refs.reserve(PAGING_ACCESSES);
+        int process = 0;
+        while (static_cast<int>(refs.size()) < PAGING_ACCESSES) {
+            if (chance(gen) < 0.02) {
+                loopBase[process] = 1 + anyPage(gen) % (PAGES_PER_PROCESS - 4);
+            }
+            for (int i = 0; i < ACCESSES_PER_QUANTUM; ++i) {
+                double r = chance(gen);
+                int page = r < 0.3 ? 0 : r < 0.95 ? loopBase[process] + loopOffset(gen) : anyPage(gen);
+                refs.push_back({ process * PAGES_PER_PROCESS + page, chance(gen) < 0.3 });
+            }
+            process = (process + 1) % PAGING_PROCESSES;
+        }
+        return refs;
+    }
+
+    // Frames and page flags for the paging simulation, laid out like the emulator's:
+    // PageTableEntry referenced/dirty bits, set on access and cleared by the policy.
+    class SimulatedMemory : public FrameAccess {
+    public:
+        SimulatedMemory()
+            : pageFlags_(PAGING_PROCESSES * PAGES_PER_PROCESS, 0),
+            frameOfPage_(PAGING_PROCESSES * PAGES_PER_PROCESS, -1),
+            pageInFrame_(PAGING_FRAMES, -1) {
+        }
+
+        uint32_t pageFlags(int frame) const override {
+            int page = pageInFrame_[frame];
+            return page < 0 ? 0 : pageFlags_[page];
+        }
+
+        void clearReferenced(int frame) override {
+            int page = pageInFrame_[frame];
+            if (page >= 0) pageFlags_[page] &= ~PageTableEntry::REFERENCED;
+        }
+
+        std::vector<uint32_t> pageFlags_;
+        std::vector<int> frameOfPage_;
+        std::vector<int> pageInFrame_;
+        int usedFrames_ = 0;
+    };
+
+    struct PagingResult {
+        uint64_t faults = 0;
+        uint64_t writeBacks = 0;
+        double accessesPerSecond = 0.0;
+    };
+
+    PagingResult simulatePolicy(const char* name, const std::vector<PageRef>& refs) {
+        std::unique_ptr<ReplacementPolicy> policy = ReplacementPolicy::create(name, PAGING_FRAMES, PAGING_WS_WINDOW);
+        SimulatedMemory mem;
+        PagingResult result;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t now = 0; now < refs.size(); ++now) {
+            const PageRef& ref = refs[now];
+            uint32_t accessFlags = ref.write
+                ? (PageTableEntry::REFERENCED | PageTableEntry::DIRTY) : PageTableEntry::REFERENCED;
+
+            if (mem.frameOfPage_[ref.page] < 0) {
+                ++result.faults;
+                int frame = mem.usedFrames_ < PAGING_FRAMES ? mem.usedFrames_++ : policy->selectVictim(mem, now);
+                int victimPage = mem.pageInFrame_[frame];
+                if (victimPage >= 0) {
+                    if (mem.pageFlags_[victimPage] & PageTableEntry::DIRTY) ++result.writeBacks;
+                    mem.pageFlags_[victimPage] = 0;
+                    mem.frameOfPage_[victimPage] = -1;
+                    policy->onRemove(frame);
+                }
+                mem.pageInFrame_[frame] = ref.page;
+                mem.frameOfPage_[ref.page] = frame;
+                policy->onLoad(frame, now);
+            }
+            mem.pageFlags_[ref.page] |= accessFlags;
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.accessesPerSecond = elapsed > 0 ? refs.size() / elapsed : 0.0;
+        return result;
+    }
+}
+
+void runQueueBenchmark(std::ostream& out) {
+    out << "\nReady queue benchmark (" << ITEMS_PER_PRODUCER << " items per producer, N producers + N consumers)\n";
+    out << "+---------+--------------------+--------------------+---------+\n";
+    out << "| Threads | TSQueue (ops/s)    | MPMCQueue (ops/s)  | Speedup |\n";
+    out << "+---------+--------------------+--------------------+---------+\n";
+
+    for (int threads : THREAD_COUNTS) {
+        double locked = measureQueue<TSQueue<std::shared_ptr<int>>>(threads);
+        double lockFree = measureQueue<MPMCQueue<std::shared_ptr<int>>>(threads);
+        double speedup = locked > 0 ? lockFree / locked : 0.0;
+
+        out << "| " << std::right << std::setw(7) << threads
+            << " | " << std::setw(18) << std::fixed << std::setprecision(0) << locked
+            << " | " << std::setw(18) << lockFree
+            << " | " << std::setw(6) << std::setprecision(2) << speedup << "x |\n";
+    }
+    out << "+---------+--------------------+--------------------+---------+\n\n";
+    out.unsetf(std::ios::floatfield);
+}
+
+void runMemoryBenchmark(std::ostream& out) {
+    out << "\nMain memory benchmark (" << MEMORY_OPS_PER_THREAD << " reads/writes per core, " << MEMORY_FRAMES
+        << " frames, each core in its own frames)\n";
+    out << "+---------+--------------------+--------------------+---------+\n";
+    out << "| Cores   | 1 lock (ops/s)     | " << std::left << std::setw(2) << MainMemory::DEFAULT_LOCK_STRIPES << std::right
+        << " stripes (ops/s) | Speedup |\n";
+    out << "+---------+--------------------+--------------------+---------+\n";
+
+    for (int threads : THREAD_COUNTS) {
+        double global = measureMemory(1, threads);
+        double striped = measureMemory(MainMemory::DEFAULT_LOCK_STRIPES, threads);
+        double speedup = global > 0 ? striped / global : 0.0;
+
+        out << "| " << std::right << std::setw(7) << threads
+            << " | " << std::setw(18) << std::fixed << std::setprecision(0) << global
+            << " | " << std::setw(18) << striped
+            << " | " << std::setw(6) << std::setprecision(2) << speedup << "x |\n";
+    }
+    out << "+---------+--------------------+--------------------+---------+\n\n";
+    out.unsetf(std::ios::floatfield);
+}
+
+void runPagingBenchmark(std::ostream& out) {
+    std::vector<PageRef> refs = makePagingWorkload();
+
+    out << "\nPage replacement benchmark (" << PAGING_ACCESSES << " accesses, " << PAGING_PROCESSES << " processes x "
+        << PAGES_PER_PROCESS << " pages, " << PAGING_FRAMES << " frames)\n";
+    out << "+---------+----------+------------+-------------+--------------------+\n";
+    out << "| Policy  | Faults   | Fault Rate | Write-backs | Accesses/s         |\n";
+    out << "+---------+----------+------------+-------------+--------------------+\n";
+
+    for (const char* name : POLICY_NAMES) {
+        PagingResult r = simulatePolicy(name, refs);
+        double faultRate = 100.0 * r.faults / refs.size();
+
+        out << "| " << std::left << std::setw(7) << name << std::right
+            << " | " << std::setw(8) << r.faults
+            << " | " << std::setw(9) << std::fixed << std::setprecision(2) << faultRate << "%"
+            << " | " << std::setw(11) << r.writeBacks
+            << " | " << std::setw(18) << std::setprecision(0) << r.accessesPerSecond << " |\n";
+    }
+    out << "+---------+----------+------------+-------------+--------------------+\n\n";
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,9 @@
+// Benchmark.h
+#pragma once
+#include <ostream>
+
+// Micro-benchmarks reachable from the console's `benchmark` command.
+// Each prints a small results table to `out`.
+void runQueueBenchmark(std::ostream& out);
+void runPagingBenchmark(std::ostream& out);
+void runMemoryBenchmark(std::ostream& out);
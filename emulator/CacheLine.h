@@ -0,0 +1,9 @@
+// CacheLine.h
+#pragma once
+#include <cstddef>
+
+// Cache line size the padding in this project is laid out for. Structures that must not
+// share a line with their neighbours put this many bytes of padding between hot fields
+// rather than using alignas(64): heap allocations only honour extended alignment from
+// C++17 on, and the project builds as C++14.
+constexpr size_t CACHE_LINE_BYTES = 64;
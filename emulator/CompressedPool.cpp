@@ -0,0 +1,146 @@
+#include "CompressedPool.h"
+#include <cstdint>
+#include <iterator>
+
+namespace {
+    constexpr uint16_t RUN_FLAG = 0x8000;
+    constexpr int MAX_RUN = 0x7FFF;
+    constexpr int MIN_RUN = 3; // Shorter repeats are cheaper left among the literals
+}
+
+CompressedPool::CompressedPool(SwapFile& swapFile, int wordsPerPage, size_t capacityBytes)
+    : swapFile_(swapFile), wordsPerPage_(wordsPerPage), capacityBytes_(capacityBytes),
+    scratch_(wordsPerPage) {
+    stats_.capacityBytes = capacityBytes;
+}
+
+void CompressedPool::addProcess(uint64_t pid) {
+    swapFile_.addProcess(pid);
+}
+
+void CompressedPool::removeProcess(uint64_t pid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.lower_bound(makePageKey(pid, 0));
+    auto end = entries_.lower_bound(makePageKey(pid + 1, 0));
+    while (it != end) {
+        auto next = std::next(it);
+        erase_unlocked(it);
+        it = next;
+    }
+    // Under the pool lock too, so a concurrent store cannot slip a page in between
+    swapFile_.removeProcess(pid);
+}
+
+bool CompressedPool::store(uint64_t pid, int page, const uint16_t* words) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PageKey key = makePageKey(pid, page);
+
+    // Any older copy in the pool is superseded whichever tier this one lands in
+    auto it = entries_.find(key);
+    if (it != entries_.end()) erase_unlocked(it);
+
+    if (capacityBytes_ > 0) {
+        std::vector<uint16_t> packed;
+        compress(words, wordsPerPage_, packed);
+        size_t packedBytes = packed.size() * sizeof(uint16_t);
+        if (packed.size() < static_cast<size_t>(wordsPerPage_) && packedBytes <= capacityBytes_) {
+            // The swap file only takes pages of processes it knows; don't hold any others
+            if (!swapFile_.isRegistered(pid)) return false;
+
+            lru_.push_front(key);
+            entries_[key] = Entry{ std::move(packed), lru_.begin() };
+            stats_.usedBytes += packedBytes;
+            stats_.originalBytes += static_cast<size_t>(wordsPerPage_) * sizeof(uint16_t);
+            while (stats_.usedBytes > capacityBytes_) spill_unlocked();
+            return true;
+        }
+        ++stats_.rejected;
+    }
+    return swapFile_.store(pid, page, words);
+}
+
+bool CompressedPool::load(uint64_t pid, int page, uint16_t* words) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(makePageKey(pid, page));
+    if (it != entries_.end() && decompress(it->second.data, words, wordsPerPage_)) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        ++stats_.poolHits;
+        return true;
+    }
+
+    // Still under the pool lock, so a page cannot be between tiers while it is looked up
+    if (!swapFile_.load(pid, page, words)) return false;
+    ++stats_.swapFileHits;
+    return true;
+}
+
+CompressedPool::Stats CompressedPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void CompressedPool::erase_unlocked(std::map<PageKey, Entry>::iterator it) {
+    stats_.usedBytes -= it->second.data.size() * sizeof(uint16_t);
+    stats_.originalBytes -= static_cast<size_t>(wordsPerPage_) * sizeof(uint16_t);
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+// Moves the least recently used page down to the swap file
+void CompressedPool::spill_unlocked() {
+    PageKey key = lru_.back();
+    auto it = entries_.find(key);
+    if (decompress(it->second.data, scratch_.data(), wordsPerPage_)) {
+        swapFile_.store(pageKeyPid(key), pageKeyPage(key), scratch_.data());
+    }
+    erase_unlocked(it);
+    ++stats_.spills;
+}
+
+void CompressedPool::compress(const uint16_t* words, int count, std::vector<uint16_t>& out) {
+    out.clear();
+    size_t literalControl = SIZE_MAX; // Index of the open literal block's control word
+
+    int i = 0;
+    while (i < count) {
+        int run = 1;
+        while (i + run < count && run < MAX_RUN && words[i + run] == words[i]) ++run;
+
+        if (run >= MIN_RUN) {
+            out.push_back(static_cast<uint16_t>(RUN_FLAG | run));
+            out.push_back(words[i]);
+            literalControl = SIZE_MAX;
+            i += run;
+            continue;
+        }
+
+        if (literalControl == SIZE_MAX || out[literalControl] == MAX_RUN) {
+            literalControl = out.size();
+            out.push_back(0);
+        }
+        ++out[literalControl];
+        out.push_back(words[i]);
+        ++i;
+    }
+}
+
+bool CompressedPool::decompress(const std::vector<uint16_t>& in, uint16_t* words, int count) {
+    int written = 0;
+    size_t i = 0;
+    while (i < in.size()) {
+        uint16_t control = in[i++];
+        int length = control & MAX_RUN;
+        if (written + length > count) return false;
+
+        if (control & RUN_FLAG) {
+            if (i >= in.size()) return false;
+            uint16_t value = in[i++];
+            for (int k = 0; k < length; ++k) words[written++] = value;
+        }
+        else {
+            if (i + length > in.size()) return false;
+            for (int k = 0; k < length; ++k) words[written++] = in[i++];
+        }
+    }
+    return written == count;
+}
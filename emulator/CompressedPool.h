@@ -0,0 +1,68 @@
+// CompressedPool.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "MainMemory.h"
+#include "SwapFile.h"
+
+// Compressed in-memory tier in front of the swap file. Stored pages are run-length encoded
+// and kept in a byte-bounded pool; when the pool is over budget the least recently used
+// pages are decompressed and spilled to the swap file. Pages that do not compress, and
+// every page when the pool size is 0, go straight to the swap file.
+class CompressedPool {
+public:
+    struct Stats {
+        size_t capacityBytes = 0;
+        size_t usedBytes = 0;     // Compressed size of the pages in the pool
+        size_t originalBytes = 0; // Their uncompressed size
+        uint64_t poolHits = 0;     // Page-ins served from the pool
+        uint64_t swapFileHits = 0; // Page-ins that had to read the swap file
+        uint64_t spills = 0;
+        uint64_t rejected = 0;     // Stores that did not compress and bypassed the pool
+    };
+
+    CompressedPool(SwapFile& swapFile, int wordsPerPage, size_t capacityBytes);
+
+    CompressedPool(const CompressedPool&) = delete;
+    CompressedPool& operator=(const CompressedPool&) = delete;
+
+    void addProcess(uint64_t pid);
+    void removeProcess(uint64_t pid);
+
+    // Same contract as SwapFile::store / SwapFile::load, across both tiers
+    bool store(uint64_t pid, int page, const uint16_t* words);
+    bool load(uint64_t pid, int page, uint16_t* words);
+
+    Stats getStats() const;
+
+    // Encodes `count` words as runs: a control word with the top bit set means the next word
+    // repeats (control & 0x7FFF) times, otherwise (control) literal words follow
+    static void compress(const uint16_t* words, int count, std::vector<uint16_t>& out);
+    // Returns false if `in` does not decode to exactly `count` words
+    static bool decompress(const std::vector<uint16_t>& in, uint16_t* words, int count);
+
+private:
+    struct Entry {
+        std::vector<uint16_t> data;
+        std::list<PageKey>::iterator lru;
+    };
+
+    void erase_unlocked(std::map<PageKey, Entry>::iterator it);
+    void spill_unlocked();
+
+    SwapFile& swapFile_;
+    int wordsPerPage_;
+    size_t capacityBytes_;
+
+    std::map<PageKey, Entry> entries_; // Ordered, so one process's pages form a contiguous range
+    std::list<PageKey> lru_;           // Most recently used first
+    std::vector<uint16_t> scratch_;    // Decompressed page on its way to the swap file
+
+    Stats stats_;
+    mutable std::mutex mutex_;
+};
@@ -17,6 +17,8 @@
 #include "GlobalState.h"
 #include "MainMemory.h"
 #include "MemoryManager.h"
+#include "Benchmark.h"
+#include "Simulation.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -35,6 +37,11 @@ struct Config {
     int          mem_per_frame = 16;
     int          min_mem_per_proc = 1024;
     int          max_mem_per_proc = 4096;
+    std::string  page_replacement = "fifo";
+    std::string  backing_store_sync = "never";
+    int          compressed_pool_size = 0;
+    std::string  clock_mode = "wall";
+    uint32_t     simulation_seed = 1;
 };
 
 
@@ -53,7 +60,8 @@ public:
     }
 
     ~Console() {
-        if (scheduler_) {
+        // A simulated scheduler has no threads to finish its processes
+        if (scheduler_ && !simulation_) {
             scheduler_->stopProcessGeneration(); 
 
             std::cout << "\nWaiting for all processes to finish before exiting...\n";
@@ -62,9 +70,7 @@ public:
             scheduler_->stop();
         }
 
-        if (cpuTickThread.joinable()) {
-            cpuTickThread.detach(); 
-        }
+        cpuClock.stop();
     }
 
 private:
@@ -101,16 +107,8 @@ private:
     }
 
     void startCpuTickThread() {
-        if (cpuTickThread.joinable()) {
-            cpuTickThread.detach();
-        }
-        cpuTickThread = std::thread([]() {
-            while (true) {
-                globalCpuTicks++;
-                std::this_thread::sleep_for(std::chrono::microseconds(1));
-            }
-            });
-        cpuTickThread.detach();
+        // Wall time keeps the clock moving while cores are idle; cores add their own ticks
+        cpuClock.start();
         cout << "CPU tick thread started." << endl;
     }
 
@@ -162,12 +160,35 @@ private:
         int usedMemBytes = usedFrames * frameSize;
         int freeMemBytes = totalMemBytes - usedMemBytes;
 
-        uint64_t totalTicks = globalCpuTicks.load();
+        uint64_t totalTicks = cpuClock.now();
         uint64_t activeTicks = scheduler_->getActiveCpuTicks();
-        uint64_t idleTicks = totalTicks - activeTicks;
+        // A simulation's clock counts ticks the cores spend in parallel once
+        uint64_t idleTicks = totalTicks > activeTicks ? totalTicks - activeTicks : 0;
+
+        double idleGapUs = scheduler_->getAverageIdleGapMicros();
+        CoreStats::Snapshot coreStats = scheduler_->getCoreStatsTotal();
+
+        uint64_t pagedIn = memoryManager_->getPagedInCount();
+        uint64_t pagedOut = memoryManager_->getPagedOutCount();
+
+        const char* policyName = memoryManager_->getReplacementPolicyName();
+        uint64_t writeBacksAvoided = memoryManager_->getWriteBacksAvoided();
+        int swapSlotsInUse = memoryManager_->getSwapSlotsInUse();
+        int swapSlotCapacity = memoryManager_->getSwapSlotCapacity();
+
+        CompressedPool::Stats pool = memoryManager_->getSwapPoolStats();
+        std::ostringstream poolUsage;
+        poolUsage << pool.usedBytes << " / " << pool.capacityBytes;
+        std::ostringstream compressionRatio;
+        if (pool.usedBytes > 0) {
+            compressionRatio << fixed << setprecision(2) << static_cast<double>(pool.originalBytes) / pool.usedBytes << "x";
+        }
+        else {
+            compressionRatio << "N/A";
+        }
 
-        int pagedIn = memoryManager_->getPagedInCount();
-        int pagedOut = memoryManager_->getPagedOutCount();
+        uint64_t tlbHits = scheduler_->getTlbHits();
+        uint64_t tlbMisses = scheduler_->getTlbMisses();
 
         cout << "\n+=======================================================================+\n";
         cout << "|                         VIRTUAL MEMORY STATISTICS                     |\n";
@@ -185,15 +206,62 @@ private:
         cout << "| CPU Idle Ticks                | " << right << setw(38) << idleTicks << "|\n";
         cout << "| CPU Active Ticks              | " << right << setw(38) << activeTicks << "|\n";
         cout << "| CPU Total Ticks               | " << right << setw(38) << totalTicks << "|\n";
+        cout << "| Avg Core Wait For Work (us)   | " << right << setw(38) << idleGapUs << "|\n";
+        cout << "| Context Switches              | " << right << setw(38) << coreStats.contextSwitches << "|\n";
+        cout << "| Page Faults                   | " << right << setw(38) << coreStats.pageFaults << "|\n";
 
         cout << "| Pages Paged In                | " << right << setw(38) << pagedIn << "|\n";
         cout << "| Pages Paged Out               | " << right << setw(38) << pagedOut << "|\n";
+        cout << "| Write-backs Avoided           | " << right << setw(38) << writeBacksAvoided << "|\n";
+        cout << "| Page Replacement              | " << right << setw(38) << policyName << "|\n";
+        cout << "| Swap Slots In Use             | " << right << setw(38) << swapSlotsInUse << "|\n";
+        cout << "| Swap Slot Capacity            | " << right << setw(38) << swapSlotCapacity << "|\n";
+        cout << "| Compressed Pool (bytes)       | " << right << setw(38) << poolUsage.str() << "|\n";
+        cout << "| Compression Ratio             | " << right << setw(38) << compressionRatio.str() << "|\n";
+        cout << "| Compressed Pool Hits          | " << right << setw(38) << pool.poolHits << "|\n";
+        cout << "| Swap File Hits                | " << right << setw(38) << pool.swapFileHits << "|\n";
+        cout << "| Compressed Pool Spills        | " << right << setw(38) << pool.spills << "|\n";
+        cout << "| TLB Hits                      | " << right << setw(38) << tlbHits << "|\n";
+        cout << "| TLB Misses                    | " << right << setw(38) << tlbMisses << "|\n";
 
         cout << "+=======================================================================+\n\n";
     }
 
 
 
+    void handleBenchmarkCommand(string which) {
+        which.erase(0, which.find_first_not_of(' '));
+        if (which == "queue") {
+            runQueueBenchmark(cout);
+        }
+        else if (which == "paging") {
+            runPagingBenchmark(cout);
+        }
+        else if (which == "memory") {
+            runMemoryBenchmark(cout);
+        }
+        else {
+            cout << "Usage: benchmark queue|paging|memory" << endl;
+        }
+    }
+
+    void handleSimulateCommand(const string& args) {
+        if (!simulation_) {
+            cout << "simulate needs clock-mode simulated in config.txt" << endl;
+            return;
+        }
+
+        std::stringstream ss(args);
+        uint64_t ticks = 0;
+        if (!(ss >> ticks) || ticks == 0) {
+            cout << "Usage: simulate <ticks>" << endl;
+            return;
+        }
+
+        Simulation::printResult(simulation_->run(ticks), cout);
+        memoryManager_->logMemorySnapshot();
+    }
+
     void handleCommand(const string& line) {
         clearScreen();
         string trimmedLine = line;
@@ -214,6 +282,11 @@ private:
             cout << "- scheduler-start: Start generating dummy processes and scheduling" << endl;
             cout << "- scheduler-stop: Stop generating dummy processes" << endl;
             cout << "- report-util: Generate CPU utilization report to file" << endl;
+            cout << "- backing-store: Write the evicted pages log to csopesy-backing-store.txt" << endl;
+            cout << "- benchmark queue: Compare ready queue throughput (TSQueue vs MPMCQueue)" << endl;
+            cout << "- benchmark paging: Compare page replacement policies on a seeded workload" << endl;
+            cout << "- benchmark memory: Compare main memory throughput with one lock vs striped frame locks" << endl;
+            cout << "- simulate <ticks>: Run the next <ticks> ticks as a discrete-event simulation (clock-mode simulated)" << endl;
             cout << "- clear: Clear the screen" << endl;
             cout << "- exit: Exit the program" << endl;
         }
@@ -233,13 +306,21 @@ private:
                 cout << "  mem-per-frame: " << cfg_.mem_per_frame << endl;
                 cout << "  min-mem-per-proc: " << cfg_.min_mem_per_proc << endl;
                 cout << "  max-mem-per-proc: " << cfg_.max_mem_per_proc << endl;
+                cout << "  page-replacement: " << cfg_.page_replacement << endl;
+                cout << "  backing-store-sync: " << cfg_.backing_store_sync << endl;
+                cout << "  compressed-pool-size: " << cfg_.compressed_pool_size << endl;
+                cout << "  clock-mode: " << cfg_.clock_mode << endl;
+                if (cfg_.clock_mode == "simulated") cout << "  simulation-seed: " << cfg_.simulation_seed << endl;
                 cout << endl;
 
                 // 1. Create MainMemory
                 mainMemory_ = std::make_unique<MainMemory>(cfg_.max_overall_mem, cfg_.mem_per_frame);
 
                 // 2. Create MemoryManager first, it no longer needs the scheduler to be created
-                memoryManager_ = std::make_unique<MemoryManager>(*mainMemory_, cfg_.min_mem_per_proc, cfg_.max_mem_per_proc, cfg_.mem_per_frame);
+                BackingStoreLog::SyncPolicy backingStoreSync = BackingStoreLog::SyncPolicy::NEVER;
+                BackingStoreLog::parseSyncPolicy(cfg_.backing_store_sync, backingStoreSync);
+                memoryManager_ = std::make_unique<MemoryManager>(*mainMemory_, cfg_.min_mem_per_proc, cfg_.max_mem_per_proc, cfg_.mem_per_frame,
+                    cfg_.page_replacement, backingStoreSync, static_cast<size_t>(cfg_.compressed_pool_size));
 
                 // 3. Now create Scheduler, passing the valid MemoryManager reference
                 scheduler_ = std::make_unique<Scheduler>(cfg_.num_cpu, cfg_.scheduler, cfg_.quantum_cycles,
@@ -249,8 +330,17 @@ private:
                 // 4. Finally, link the MemoryManager back to the Scheduler using the new setter
                 memoryManager_->setScheduler(scheduler_.get());
 
-                scheduler_->start();
-                startCpuTickThread();
+                if (cfg_.clock_mode == "simulated") {
+                    // No threads: the clock only moves when `simulate` steps the scheduler
+                    Process::seedRandom(cfg_.simulation_seed);
+                    MemoryManager::seedRandom(cfg_.simulation_seed);
+                    simulation_ = std::make_unique<Simulation>(*scheduler_);
+                    cout << "Simulated clock ready. Use simulate <ticks> to run." << endl;
+                }
+                else {
+                    scheduler_->start();
+                    startCpuTickThread();
+                }
             }
             else {
                 cout << "Initialization failed. Check config.txt\n";
@@ -436,6 +526,9 @@ private:
                 }
                 cout << "----------------------------\n";
             }
+            else if (simulation_ && (trimmedLine == "scheduler-start" || trimmedLine == "scheduler-stop")) {
+                cout << "The simulated clock generates batch processes during simulate <ticks>." << endl;
+            }
             else if (trimmedLine == "scheduler-start") {
                 scheduler_->startProcessGeneration();
                 cout << "Scheduler process generation started." << endl;
@@ -452,12 +545,21 @@ private:
             else if (trimmedLine == "report-util") {
                 generateReport();
             }
+            else if (trimmedLine == "backing-store") {
+                generateBackingStoreReport();
+            }
             else if (trimmedLine == "process-smi") {
                 handleProcessSmiCommand();
             }
             else if (trimmedLine == "vmstat") {
                 handleVmstatCommand();
             }
+            else if (trimmedLine.rfind("benchmark", 0) == 0) {
+                handleBenchmarkCommand(trimmedLine.substr(9));
+            }
+            else if (trimmedLine.rfind("simulate", 0) == 0) {
+                handleSimulateCommand(trimmedLine.substr(8));
+            }
             else {
                 cout << "[" << getCurrentTimestamp() << "] Unknown command: " << trimmedLine << '\n';
             }
@@ -537,6 +639,21 @@ private:
         cout << "Report written to csopesy-log.txt\n";
     }
 
+    void generateBackingStoreReport() {
+        ofstream out("csopesy-backing-store.txt");
+        if (!out) {
+            cout << "Error: Cannot create csopesy-backing-store.txt\n";
+            return;
+        }
+
+        int count = memoryManager_->renderBackingStore(out);
+        if (count < 0) {
+            cout << "Error: Cannot read " << MemoryManager::BACKING_STORE_LOG_PATH << "\n";
+            return;
+        }
+        cout << count << " evicted page(s) written to csopesy-backing-store.txt\n";
+    }
+
     bool loadConfigFile(const string& path) {
         ifstream in(path);
         if (!in) { cout << "config.txt not found!\n"; return false; }
@@ -557,6 +674,12 @@ private:
             cfg_.mem_per_frame = stoi(kv.at("mem-per-frame"));
             cfg_.min_mem_per_proc = stoi(kv.at("min-mem-per-proc"));
             cfg_.max_mem_per_proc = stoi(kv.at("max-mem-per-proc"));
+            // Optional; older config files leave it out
+            if (kv.count("page-replacement")) cfg_.page_replacement = kv.at("page-replacement");
+            if (kv.count("backing-store-sync")) cfg_.backing_store_sync = kv.at("backing-store-sync");
+            if (kv.count("compressed-pool-size")) cfg_.compressed_pool_size = stoi(kv.at("compressed-pool-size"));
+            if (kv.count("clock-mode")) cfg_.clock_mode = kv.at("clock-mode");
+            if (kv.count("simulation-seed")) cfg_.simulation_seed = static_cast<uint32_t>(stoul(kv.at("simulation-seed")));
         }
         catch (...) {
             cout << "Malformed config.txt – missing field or unexpected error\n";
@@ -569,6 +692,27 @@ private:
             return false;
         }
 
+        if (!ReplacementPolicy::isValidName(cfg_.page_replacement)) {
+            cout << "Configuration error: page-replacement must be one of fifo, clock, lru, wsclock." << endl;
+            return false;
+        }
+
+        BackingStoreLog::SyncPolicy sync;
+        if (!BackingStoreLog::parseSyncPolicy(cfg_.backing_store_sync, sync)) {
+            cout << "Configuration error: backing-store-sync must be one of never, batch, always." << endl;
+            return false;
+        }
+
+        if (cfg_.compressed_pool_size < 0) {
+            cout << "Configuration error: compressed-pool-size cannot be negative." << endl;
+            return false;
+        }
+
+        if (cfg_.clock_mode != "wall" && cfg_.clock_mode != "simulated") {
+            cout << "Configuration error: clock-mode must be one of wall, simulated." << endl;
+            return false;
+        }
+
         return true;
     }
 
@@ -583,6 +727,6 @@ private:
     std::unique_ptr<MainMemory> mainMemory_;
     std::unique_ptr<MemoryManager> memoryManager_;
     std::unique_ptr<Scheduler> scheduler_;
+    std::unique_ptr<Simulation> simulation_; // Only with clock-mode simulated
     std::unique_ptr<Screen> activeScreen_;
-    std::thread cpuTickThread;
 };
@@ -12,107 +12,221 @@ using std::cerr;
 using std::exception;
 using std::thread;
 
+thread_local CoreStats* CoreStats::threadStats_ = nullptr;
+
+// Out-of-line definitions: the waits take these durations by reference
+constexpr std::chrono::microseconds Core::DELAY_WAIT_SLICE;
+constexpr std::chrono::milliseconds Core::PARK_FALLBACK_TIMEOUT;
+
+static int64_t steadyNowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 Core::Core(int id, Scheduler* scheduler, uint64_t delayPerExec)
-    : id_(id), busy_(false), scheduler(scheduler), delayPerExec_(delayPerExec) {
+    : id_(id), busy_(false), stopping_(false), parked_(false), idleSinceNanos_(steadyNowNanos()),
+    scheduler(scheduler), delayPerExec_(delayPerExec) {
 }
 
 Core::~Core() {
-    if (worker_.joinable()) {
-        worker_.join();
+    stop();
+}
+
+void Core::start() {
+    if (!worker_.joinable() && !stopping_) {
+        worker_ = std::thread(&Core::workerLoop, this);
     }
 }
 
 void Core::stop() {
-    busy_ = false;
+    stopping_ = true;
+    wake();
+    cpuClock.interruptWaiters();
+
+    if (worker_.joinable() && !isWorkerThread()) {
+        worker_.join();
+    }
+}
+
+bool Core::wake() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (wakeRequested_) return false;
+        wakeRequested_ = true;
+    }
+    wakeCv_.notify_one();
+    return true;
 }
 
 bool Core::isBusy() const {
     return busy_;
 }
 
-bool Core::tryAssign(std::shared_ptr<Process> p, uint64_t quantum) {
-    if (busy_) return false;
-
-    if (worker_.joinable()) {
-        worker_.join();
-    }
-
-    runningProcess = p;
-    p->setLastCoreId(id_);
-    busy_ = true;
+bool Core::pushLocal(std::shared_ptr<Process> p) {
+    std::lock_guard<std::mutex> lock(runQueueMutex_);
+    bool hadWork = !runQueue_.empty();
+    runQueue_.push_back(std::move(p));
+    return hadWork;
+}
 
-    try {
-        worker_ = std::thread(&Core::workerLoop, this, p, quantum);
-    }
-    catch (const std::system_error& e) {
-        std::cerr << "[Core-" << id_ << "] Failed to start thread: " << e.what() << std::endl;
-        busy_ = false;
-        runningProcess = nullptr;
-        return false;
-    }
+bool Core::popLocal(std::shared_ptr<Process>& p) {
+    std::lock_guard<std::mutex> lock(runQueueMutex_);
+    if (runQueue_.empty()) return false;
+    p = std::move(runQueue_.front());
+    runQueue_.pop_front();
+    return true;
+}
 
+bool Core::stealLocal(std::shared_ptr<Process>& p) {
+    std::lock_guard<std::mutex> lock(runQueueMutex_);
+    if (runQueue_.empty()) return false;
+    p = std::move(runQueue_.back());
+    runQueue_.pop_back();
     return true;
 }
 
-void Core::workerLoop(std::shared_ptr<Process> p, uint64_t quantum) {
-    if (!p->hasBeenScheduled()) {
-        int memToAlloc = p->getAllocatedMemory();
-        if (scheduler->getMemoryManager().allocateMemory(p, memToAlloc)) {
-            p->setHasBeenScheduled(true);
-        }
-        else {
-            if (scheduler) scheduler->requeueProcess(p);
-            busy_ = false;
-            runningProcess = nullptr;
-            return;
+size_t Core::localQueueSize() const {
+    std::lock_guard<std::mutex> lock(runQueueMutex_);
+    return runQueue_.size();
+}
+
+// Persistent worker: pulls the next process (local queue, global queue, then stealing),
+// runs one quantum, and parks only when no work can be found anywhere.
+void Core::workerLoop() {
+    bindToCurrentThread();
+
+    while (!stopping_) {
+        std::shared_ptr<Process> p = scheduler->acquireNextProcess(id_);
+        if (!p) {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            parked_ = true;
+            // Re-check after publishing parked_; a push after this point sees parked_ and wakes us
+            lock.unlock();
+            p = scheduler->acquireNextProcess(id_);
+            lock.lock();
+            if (!p) {
+                // Every push that leaves work for someone else wakes a parked core; the
+                // timeout is only a backstop and normally never expires with work queued
+                wakeCv_.wait_for(lock, PARK_FALLBACK_TIMEOUT,
+                    [this]() { return wakeRequested_ || stopping_.load(); });
+                wakeRequested_ = false;
+                parked_ = false;
+                continue;
+            }
+            wakeRequested_ = false;
+            parked_ = false;
         }
+
+        runQuantum(std::move(p), scheduler->getQuantum());
     }
 
+    busy_ = false;
+    std::atomic_store(&runningProcess, std::shared_ptr<Process>());
+}
+
+void Core::bindToCurrentThread() {
+    MemoryManager::bindThreadTlb(&tlb_);
+    CoreStats::bindThread(&stats_);
+}
+
+void Core::runQuantum(std::shared_ptr<Process> p, uint64_t quantum) {
+    if (!beginQuantum(p)) return;
+
     uint64_t executed = 0;
+    uint64_t unpublished = 0; // Ticks executed but not yet added to the clock and the stats
+    StepResult result = StepResult::RETIRED;
 
-    while (busy_.load() && !p->isFinished() && executed < quantum) {
-        if (p->isSleeping()) {
-            if (scheduler) scheduler->requeueProcess(p);
-            break;
-        }
+    while (!stopping_.load() && executed < quantum) {
+        result = step(p);
+        if (result == StepResult::BLOCKED || result == StepResult::FAILED) break;
+
+        executed++;
+        unpublished++;
 
-        try {
-            // CHANGE: Check the return value of runOneInstruction
-            bool ran = p->runOneInstruction(id_);
-            if (!ran) {
-                // CHANGE: If runOneInstruction returns false, it means the process is stalled.
-                // We should stop trying to run it and put it back in the queue.
-                if (scheduler) scheduler->requeueProcess(p);
-                break; // Break the while loop to stop the core
+        if (delayPerExec_ == 0) {
+            if (unpublished >= TICK_PUBLISH_BATCH) {
+                publishTicks(unpublished);
+                unpublished = 0;
             }
         }
-        catch (const std::exception& e) {
-            std::cerr << "[Core-" << id_ << "] Process " << p->getName() << " terminated with exception: " << e.what() << std::endl;
-            break;
+        else {
+            // Publish first: the wait is measured from this instruction's tick
+            publishTicks(unpublished);
+            unpublished = 0;
+            uint64_t targetTick = cpuClock.now() + delayPerExec_;
+            while (!stopping_.load() &&
+                !cpuClock.waitUntil(targetTick, DELAY_WAIT_SLICE, [this]() { return stopping_.load(); })) {
+            }
         }
 
-        globalCpuTicks.fetch_add(1);
-        scheduler->updateCoreUtilization(id_, 1);
-        executed++;
+        if (result == StepResult::SLEPT) break;
+    }
 
-        if (delayPerExec_ == 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    publishTicks(unpublished);
+    endQuantum(p, executed, quantum, result);
+}
+
+void Core::publishTicks(uint64_t ticks) {
+    cpuClock.advance(ticks);
+    countTicks(ticks);
+}
+
+bool Core::beginQuantum(const std::shared_ptr<Process>& p) {
+    int64_t gap = steadyNowNanos() - idleSinceNanos_.load();
+    if (gap > 0) CoreStats::add(stats_.idleGapNanos, static_cast<uint64_t>(gap));
+    CoreStats::add(stats_.idleGapCount, 1);
+
+    if (p->getPid() != lastPid_) {
+        tlb_.flush();
+        lastPid_ = p->getPid();
+        CoreStats::add(stats_.contextSwitches, 1);
+    }
+
+    std::atomic_store(&runningProcess, p);
+    p->setLastCoreId(id_);
+    busy_ = true;
+
+    if (!p->hasBeenScheduled()) {
+        int memToAlloc = p->getAllocatedMemory();
+        if (scheduler->getMemoryManager().allocateMemory(p, memToAlloc)) {
+            p->setHasBeenScheduled(true);
         }
         else {
-            uint64_t targetTick = globalCpuTicks.load() + delayPerExec_;
-            while (globalCpuTicks.load() < targetTick) {
-                std::this_thread::yield();
-            }
+            if (scheduler) scheduler->requeueProcess(p);
+            goIdle();
+            return false;
         }
     }
+    return true;
+}
+
+Core::StepResult Core::step(const std::shared_ptr<Process>& p) {
+    if (p->isSleeping()) return StepResult::BLOCKED;
+
+    try {
+        // false means the process finished, or stalled and should go back in the queue
+        if (!p->runOneInstruction(id_)) return StepResult::BLOCKED;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Core-" << id_ << "] Process " << p->getName() << " terminated with exception: " << e.what() << std::endl;
+        return StepResult::FAILED;
+    }
+    return p->isSleeping() ? StepResult::SLEPT : StepResult::RETIRED;
+}
 
+void Core::endQuantum(const std::shared_ptr<Process>& p, uint64_t executed, uint64_t quantum, StepResult last) {
     if (p->isFinished()) {
         if (scheduler) scheduler->addFinishedProcess(p);
     }
-    else if (executed >= quantum) {
+    else if (last == StepResult::SLEPT || last == StepResult::BLOCKED || executed >= quantum) {
         if (scheduler) scheduler->requeueProcess(p);
     }
 
+    goIdle();
+}
+
+void Core::goIdle() {
+    idleSinceNanos_ = steadyNowNanos();
     busy_ = false;
-    runningProcess = nullptr;
+    std::atomic_store(&runningProcess, std::shared_ptr<Process>());
 }
@@ -2,10 +2,15 @@
 #include <memory>       
 #include <atomic>      
 #include <thread>       
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <chrono> 
 #include "Process.h"
 #include "GlobalState.h"
+#include "TLB.h"
+#include "CoreStats.h"
 
 class Scheduler;
 
@@ -16,21 +21,84 @@ public:
 
     int id_;
     bool isBusy() const;
-
-    bool tryAssign(std::shared_ptr<Process> p, uint64_t quantum);
+    bool isParked() const { return parked_.load(); }
+    bool isWorkerThread() const { return worker_.get_id() == std::this_thread::get_id(); }
 
     std::shared_ptr<Process> getRunningProcess() const {
-        return busy_ ? runningProcess : nullptr;
+        return busy_ ? std::atomic_load(&runningProcess) : nullptr;
     }
 
+    // Local run queue. The owning core pops from the front; idle cores steal from the back.
+    // Returns whether the queue already held work
+    bool pushLocal(std::shared_ptr<Process> p);
+    bool popLocal(std::shared_ptr<Process>& p);
+    bool stealLocal(std::shared_ptr<Process>& p);
+    size_t localQueueSize() const;
+
+    // Returns false if a wakeup was already pending
+    bool wake();
+    void start();
     void stop();
 
+    // Ticks, faults, context switches and idle gaps (time from going idle to the next
+    // dispatch, accumulated across all idle periods); ticks trail by under TICK_PUBLISH_BATCH
+    CoreStats::Snapshot getStats() const { return stats_.snapshot(); }
+
+    const TLB& getTlb() const { return tlb_; }
+
+    // A quantum is beginQuantum, then step() while it returns RETIRED and the quantum lasts,
+    // then endQuantum. The worker thread makes these calls in real time; Simulation makes
+    // them from its event queue with no worker running.
+    enum class StepResult {
+        RETIRED, // An instruction ran and the process can run another
+        SLEPT,   // An instruction ran and put the process to sleep
+        BLOCKED, // Nothing ran: the process has finished, is asleep or stalled
+        FAILED   // The instruction threw; the process is dropped
+    };
+
+    // Puts `p` on the core; false if its memory could not be allocated (it is requeued)
+    bool beginQuantum(const std::shared_ptr<Process>& p);
+    StepResult step(const std::shared_ptr<Process>& p);
+    // Adds executed instructions to the core's tick count; whoever drives step() calls it
+    void countTicks(uint64_t ticks) { CoreStats::add(stats_.ticks, ticks); }
+    // Hands `p` back to the scheduler after `executed` instructions, `last` being the final step
+    void endQuantum(const std::shared_ptr<Process>& p, uint64_t executed, uint64_t quantum, StepResult last);
+
+    // Makes the calling thread's page translations and stats go to this core
+    void bindToCurrentThread();
+
 private:
-    void workerLoop(std::shared_ptr<Process> p, uint64_t quantum);
+    // Without a delay-per-exec, executed ticks reach the shared clock and stats in batches of this many
+    static constexpr uint64_t TICK_PUBLISH_BATCH = 32;
+    // Longest a delay-per-exec wait blocks before re-checking for shutdown
+    static constexpr std::chrono::microseconds DELAY_WAIT_SLICE{ 10000 };
+    // Longest a parked core sleeps without being woken
+    static constexpr std::chrono::milliseconds PARK_FALLBACK_TIMEOUT{ 1000 };
+
+    void workerLoop();
+    void runQuantum(std::shared_ptr<Process> p, uint64_t quantum);
+    void goIdle();
+    void publishTicks(uint64_t ticks);
     std::atomic<bool> busy_;
+    std::atomic<bool> stopping_;
     std::thread worker_;
     std::shared_ptr<Process> runningProcess;
 
+    mutable std::mutex runQueueMutex_;
+    std::deque<std::shared_ptr<Process>> runQueue_;
+
+    // The worker parks here when there is nothing to run locally, globally or to steal.
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool wakeRequested_ = false;
+    std::atomic<bool> parked_;
+
+    std::atomic<int64_t> idleSinceNanos_;
+    CoreStats stats_;
+
+    TLB tlb_;
+    uint64_t lastPid_ = UINT64_MAX;
+
     Scheduler* scheduler;
     uint64_t delayPerExec_;
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+// CoreStats.h
+#pragma once
+#include "CacheLine.h"
+#include <atomic>
+#include <cstdint>
+
+// Counters one core keeps about itself, padded by a cache line on each side so cores never
+// write to a line another core is writing, wherever the owning Core is allocated. Only the core's worker thread updates them, so
+// an update is a relaxed load and store rather than a locked read-modify-write; the worker
+// accumulates ticks locally and publishes them in batches. Any thread may read them.
+struct CoreStats {
+    // Plain copy for aggregating and printing
+    struct Snapshot {
+        uint64_t ticks = 0; // One per executed instruction
+        uint64_t pageFaults = 0;
+        uint64_t contextSwitches = 0;
+        uint64_t idleGapCount = 0;
+        uint64_t idleGapNanos = 0;
+
+        Snapshot& operator+=(const Snapshot& o) {
+            ticks += o.ticks;
+            pageFaults += o.pageFaults;
+            contextSwitches += o.contextSwitches;
+            idleGapCount += o.idleGapCount;
+            idleGapNanos += o.idleGapNanos;
+            return *this;
+        }
+    };
+
+    char leadingPad[CACHE_LINE_BYTES];
+    std::atomic<uint64_t> ticks{ 0 };
+    std::atomic<uint64_t> pageFaults{ 0 };
+    std::atomic<uint64_t> contextSwitches{ 0 };
+    std::atomic<uint64_t> idleGapCount{ 0 };
+    std::atomic<uint64_t> idleGapNanos{ 0 };
+    char trailingPad[CACHE_LINE_BYTES];
+
+    // Single-writer add
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.ticks = ticks.load(std::memory_order_relaxed);
+        s.pageFaults = pageFaults.load(std::memory_order_relaxed);
+        s.contextSwitches = contextSwitches.load(std::memory_order_relaxed);
+        s.idleGapCount = idleGapCount.load(std::memory_order_relaxed);
+        s.idleGapNanos = idleGapNanos.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // The stats block of the core whose worker is the calling thread, or nullptr
+    static CoreStats* forThread() { return threadStats_; }
+    static void bindThread(CoreStats* stats) { threadStats_ = stats; }
+
+private:
+    static thread_local CoreStats* threadStats_;
+};
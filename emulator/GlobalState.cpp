@@ -1,4 +1,4 @@
 // GlobalState.cpp
 #include "GlobalState.h"
 
-std::atomic<uint64_t> globalCpuTicks(0);
\ No newline at end of file
+VirtualClock cpuClock;
\ No newline at end of file
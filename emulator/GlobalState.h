@@ -1,7 +1,6 @@
 // GlobalState.h
 #pragma once
-#include <atomic>
-#include <cstdint>
+#include "VirtualClock.h"
 
-// Global atomic counter for CPU ticks
-extern std::atomic<uint64_t> globalCpuTicks;
\ No newline at end of file
+// Emulated CPU time, shared by every core, process and the scheduler
+extern VirtualClock cpuClock;
\ No newline at end of file
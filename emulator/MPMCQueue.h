@@ -0,0 +1,179 @@
+// MPMCQueue.h
+// Bounded lock-free multi-producer/multi-consumer ring (Vyukov-style sequence numbers)
+#pragma once
+#include "CacheLine.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+template <typename T>
+class MPMCQueue {
+private:
+    // Each cell's sequence number tells producers and consumers whose turn it is:
+    // seq == pos means free for the producer at pos, seq == pos + 1 means filled.
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    static constexpr int SPIN_LIMIT = 64;
+
+    std::unique_ptr<Cell[]> m_buffer;
+    size_t m_mask;
+
+    // Producers, consumers and the blocking fallback each get their own cache lines; the
+    // padding is explicit because the queue usually lives inside a heap-allocated owner
+    char m_pad0[CACHE_LINE_BYTES];
+    std::atomic<size_t> m_enqueuePos;
+    char m_pad1[CACHE_LINE_BYTES];
+    std::atomic<size_t> m_dequeuePos;
+    char m_pad2[CACHE_LINE_BYTES];
+
+    // Blocking fallback, only touched when the ring is empty (pop) or full (push)
+    std::atomic<int> m_waitingConsumers;
+    std::atomic<int> m_waitingProducers;
+    std::mutex m_waitMutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+
+    static size_t roundUpPow2(size_t n) {
+        size_t cap = 2;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void wake(std::atomic<int>& waiters, std::condition_variable& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_waitMutex);
+            cond.notify_one();
+        }
+    }
+
+    bool enqueue(T& item) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_buffer[pos & m_mask];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = std::move(item);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool dequeue(T& item) {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_buffer[pos & m_mask];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.data);
+                    cell.data = T();
+                    cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    explicit MPMCQueue(size_t capacity = 65536)
+        : m_buffer(new Cell[roundUpPow2(capacity)]), m_mask(roundUpPow2(capacity) - 1),
+        m_enqueuePos(0), m_dequeuePos(0), m_waitingConsumers(0), m_waitingProducers(0) {
+        for (size_t i = 0; i <= m_mask; ++i) {
+            m_buffer[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    // Non-blocking push; returns false (leaving item untouched) if the ring is full
+    bool try_push(T&& item) {
+        if (!enqueue(item)) return false;
+        wake(m_waitingConsumers, m_notEmpty);
+        return true;
+    }
+
+    // Non-blocking try_pop; returns false if the ring is empty
+    bool try_pop(T& item) {
+        if (!dequeue(item)) return false;
+        wake(m_waitingProducers, m_notFull);
+        return true;
+    }
+
+    // Pushes an element, blocking while the ring is full
+    void push(T item) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (try_push(std::move(item))) return;
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitingProducers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_notFull.wait(lock, [&]() { return enqueue(item); });
+            m_waitingProducers.fetch_sub(1);
+        }
+        wake(m_waitingConsumers, m_notEmpty);
+    }
+
+    // Pops an element off the queue, blocking while the ring is empty
+    T pop() {
+        T item;
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (try_pop(item)) return item;
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitingConsumers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_notEmpty.wait(lock, [&]() { return dequeue(item); });
+            m_waitingConsumers.fetch_sub(1);
+        }
+        wake(m_waitingProducers, m_notFull);
+        return item;
+    }
+
+    // Approximate while other threads are pushing or popping
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t size() const {
+        size_t head = m_dequeuePos.load(std::memory_order_acquire);
+        size_t tail = m_enqueuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+};
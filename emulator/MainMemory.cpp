@@ -1,46 +1,93 @@
 #include "MainMemory.h"
-#include <sstream>
-#include <iomanip>
-
-MainMemory::MainMemory(int totalBytes, int frameSize)
-    : totalMemoryBytes(totalBytes), frameSize(frameSize) {
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit; `bits` must be non-zero
+static int lowestSetBit(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+MainMemory::MainMemory(int totalBytes, int frameSize, int lockStripes)
+    : totalMemoryBytes(totalBytes), frameSize(frameSize),
+    stripes_(new LockStripe[lockStripes > 0 ? lockStripes : 1]), stripeCount_(lockStripes > 0 ? lockStripes : 1) {
     totalFrames = totalMemoryBytes / frameSize;
-    frameTable.resize(totalFrames, "");
-    validBits.resize(totalFrames, false);
+    wordsPerFrame = frameSize / 2;
+    words.assign(static_cast<size_t>(totalFrames) * wordsPerFrame, 0);
+    frameTable.resize(totalFrames, NO_PAGE);
+
+    // Every frame starts free; bits past the last frame stay clear so they are never found
+    freeBitmap_.assign((totalFrames + 63) / 64, ~0ULL);
+    if (totalFrames % 64 != 0) {
+        freeBitmap_.back() = (1ULL << (totalFrames % 64)) - 1;
+    }
 }
 
 // --- Private Unlocked Helpers ---
 
+bool MainMemory::_isFree_unlocked(int index) const {
+    return (freeBitmap_[index / 64] >> (index % 64)) & 1ULL;
+}
+
+void MainMemory::_claimFrame_unlocked(int index) {
+    if (_isFree_unlocked(index)) {
+        freeBitmap_[index / 64] &= ~(1ULL << (index % 64));
+        usedFrames_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MainMemory::_releaseFrame_unlocked(int index) {
+    if (!_isFree_unlocked(index)) {
+        freeBitmap_[index / 64] |= 1ULL << (index % 64);
+        usedFrames_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
 void MainMemory::_clearFrame_unlocked(int index) {
     if (index >= 0 && index < totalFrames) {
-        frameTable[index].clear();
-        validBits[index] = false;
+        frameTable[index] = NO_PAGE;
+        _releaseFrame_unlocked(index);
     }
 }
 
-void MainMemory::_writeMemory_unlocked(const std::string& address, uint16_t value) {
-    memory[address] = value;
+void MainMemory::_writeMemory_unlocked(int physicalAddr, uint16_t value) {
+    size_t word = static_cast<size_t>(physicalAddr) / 2;
+    if (physicalAddr >= 0 && word < words.size()) words[word] = value;
 }
 
-uint16_t MainMemory::_readMemory_unlocked(const std::string& address) const {
-    auto it = memory.find(address);
-    return (it != memory.end()) ? it->second : 0;
+uint16_t MainMemory::_readMemory_unlocked(int physicalAddr) const {
+    size_t word = static_cast<size_t>(physicalAddr) / 2;
+    return (physicalAddr >= 0 && word < words.size()) ? words[word] : 0;
 }
 
-int MainMemory::_getFreeFrameIndex_unlocked() const {
-    for (int i = 0; i < totalFrames; ++i)
-        if (!validBits[i]) return i;
-    return -1;
+int MainMemory::_parseAddress(const std::string& address) {
+    try {
+        return std::stoi(address, nullptr, 16);
+    }
+    catch (...) {
+        return -1;
+    }
 }
 
-int MainMemory::_getUsedFrames_unlocked() const {
-    int used = 0;
-    for (bool bit : validBits) {
-        if (bit) {
-            used++;
+// Scans the bitmap a word at a time, starting from the word the last allocation came from
+int MainMemory::_getFreeFrameIndex_unlocked() const {
+    if (usedFrames_.load(std::memory_order_relaxed) >= totalFrames) return -1;
+
+    size_t wordCount = freeBitmap_.size();
+    for (size_t n = 0; n < wordCount; ++n) {
+        size_t w = (searchHint_ + n) % wordCount;
+        if (freeBitmap_[w] != 0) {
+            return static_cast<int>(w * 64) + lowestSetBit(freeBitmap_[w]);
         }
     }
-    return used;
+    return -1;
 }
 
 // --- Public Locking Wrappers ---
@@ -49,19 +96,19 @@ int MainMemory::getTotalFrames() const {
     return totalFrames;
 }
 
-int MainMemory::getFreeFrameIndex() const {
+int MainMemory::allocateFrame() {
     std::lock_guard<std::mutex> lock(memoryMutex_);
-    return _getFreeFrameIndex_unlocked();
-}
-
-bool MainMemory::isFrameValid(int index) const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return (index >= 0 && static_cast<size_t>(index) < validBits.size()) ? validBits[static_cast<size_t>(index)] : false;
+    int index = _getFreeFrameIndex_unlocked();
+    if (index != -1) {
+        _claimFrame_unlocked(index);
+        searchHint_ = index / 64;
+    }
+    return index;
 }
 
-void MainMemory::setFrame(int index, const std::string& pageId) {
+void MainMemory::setFrame(int index, PageKey page) {
     std::lock_guard<std::mutex> lock(memoryMutex_);
-    if (index >= 0 && index < totalFrames) frameTable[index] = pageId;
+    if (index >= 0 && index < totalFrames) frameTable[index] = page;
 }
 
 void MainMemory::clearFrame(int index) {
@@ -69,103 +116,68 @@ void MainMemory::clearFrame(int index) {
     _clearFrame_unlocked(index);
 }
 
-void MainMemory::markFrameValid(int index) {
+PageKey MainMemory::getPageAtFrame(int index) const {
     std::lock_guard<std::mutex> lock(memoryMutex_);
-    if (index >= 0 && index < totalFrames) validBits[index] = true;
+    if (index >= 0 && index < totalFrames) return frameTable[index];
+    return NO_PAGE;
 }
 
-void MainMemory::markFrameInvalid(int index) {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    if (index >= 0 && index < totalFrames) validBits[index] = false;
+void MainMemory::write(int physicalAddr, uint16_t value) {
+    size_t word = static_cast<size_t>(physicalAddr) / 2;
+    if (physicalAddr < 0 || word >= words.size()) return;
+
+    std::lock_guard<std::mutex> lock(frameLock(static_cast<int>(word / wordsPerFrame)));
+    _writeMemory_unlocked(physicalAddr, value);
 }
 
-std::string MainMemory::getPageAtFrame(int index) const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    if (index >= 0 && index < totalFrames) return frameTable[index];
-    return "";
+uint16_t MainMemory::read(int physicalAddr) const {
+    size_t word = static_cast<size_t>(physicalAddr) / 2;
+    if (physicalAddr < 0 || word >= words.size()) return 0;
+
+    std::lock_guard<std::mutex> lock(frameLock(static_cast<int>(word / wordsPerFrame)));
+    return _readMemory_unlocked(physicalAddr);
 }
 
-void MainMemory::writeMemory(const std::string& address, uint16_t value) {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    _writeMemory_unlocked(address, value);
+std::unique_lock<std::mutex> MainMemory::lockFrame(int frameIndex) const {
+    return std::unique_lock<std::mutex>(frameLock(frameIndex));
 }
 
-uint16_t MainMemory::readMemory(const std::string& address) const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return _readMemory_unlocked(address);
+void MainMemory::write_unlocked(int physicalAddr, uint16_t value) {
+    _writeMemory_unlocked(physicalAddr, value);
 }
 
-bool MainMemory::addressExists(const std::string& address) const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return memory.count(address) > 0;
+uint16_t MainMemory::read_unlocked(int physicalAddr) const {
+    return _readMemory_unlocked(physicalAddr);
 }
 
-std::unordered_map<std::string, uint16_t>& MainMemory::getMemoryMap() {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return memory;
+bool MainMemory::addressExists(const std::string& address) const {
+    int addr = _parseAddress(address);
+    return addr >= 0 && addr < totalMemoryBytes;
 }
 
-const std::vector<std::string>& MainMemory::getFrameTable() const {
+std::vector<PageKey> MainMemory::getFrameTable() const {
     std::lock_guard<std::mutex> lock(memoryMutex_);
     return frameTable;
 }
 
-const std::vector<bool>& MainMemory::getValidBits() const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return validBits;
-}
+std::vector<uint16_t> MainMemory::dumpPageFromFrame_unlocked(int frameIndex) const {
+    if (frameIndex < 0 || frameIndex >= totalFrames) return {};
 
-std::vector<int> MainMemory::freeFramesByPagePrefix(const std::string& prefix) {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    std::vector<int> freedFrames;
-    for (size_t i = 0; i < frameTable.size(); ++i) {
-        if (validBits[i] && frameTable[i].find(prefix) == 0) {
-            _clearFrame_unlocked(static_cast<int>(i));
-            freedFrames.push_back(static_cast<int>(i));
-        }
-    }
-    return freedFrames;
+    auto first = words.begin() + static_cast<size_t>(frameIndex) * wordsPerFrame;
+    return std::vector<uint16_t>(first, first + wordsPerFrame);
 }
 
-std::vector<uint16_t> MainMemory::dumpPageFromFrame(int frameIndex, const std::string& baseAddress) {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    int words_per_frame = frameSize / 2; // Calculate words
-    std::vector<uint16_t> data;
-    data.reserve(words_per_frame); // Reserve correct size
-    int base = std::stoi(baseAddress, nullptr, 16);
-
-    // Loop over words, not bytes, and calculate address correctly
-    for (int i = 0; i < words_per_frame; ++i) {
-        std::stringstream ss;
-        // Physical addresses for words are 2 bytes apart
-        ss << "0x" << std::hex << std::uppercase << (base + (i * 2));
-        std::string addr = ss.str();
-        data.push_back(_readMemory_unlocked(addr));
-    }
+void MainMemory::loadPageToFrame(int frameIndex, const std::vector<uint16_t>& data) {
+    if (frameIndex < 0 || frameIndex >= totalFrames) return;
+    std::lock_guard<std::mutex> lock(frameLock(frameIndex));
 
-    return data;
+    size_t count = std::min(data.size(), static_cast<size_t>(wordsPerFrame));
+    std::copy_n(data.begin(), count, words.begin() + static_cast<size_t>(frameIndex) * wordsPerFrame);
 }
 
-void MainMemory::loadPageToFrame(int frameIndex, const std::vector<uint16_t>& data, const std::string& baseAddress) {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    int base = std::stoi(baseAddress, nullptr, 16);
-
-    // Loop over the words in the data vector
-    for (size_t i = 0; i < data.size(); ++i) {
-        std::stringstream ss;
-        // Physical addresses for words are 2 bytes apart
-        ss << "0x" << std::hex << std::uppercase << (base + static_cast<int>(i * 2));
-        std::string addr = ss.str();
-        _writeMemory_unlocked(addr, data[i]);
-    }
-}
+void MainMemory::zeroFrame(int frameIndex) {
+    if (frameIndex < 0 || frameIndex >= totalFrames) return;
+    std::lock_guard<std::mutex> lock(frameLock(frameIndex));
 
-int MainMemory::getUsedFrames() const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return _getUsedFrames_unlocked();
+    std::fill_n(words.begin() + static_cast<size_t>(frameIndex) * wordsPerFrame, wordsPerFrame, uint16_t{ 0 });
 }
-
-int MainMemory::getFreeFrames() const {
-    std::lock_guard<std::mutex> lock(memoryMutex_);
-    return _getFreeFrameIndex_unlocked() == -1 ? 0 : totalFrames - _getUsedFrames_unlocked();
-}
\ No newline at end of file
@@ -1,38 +1,55 @@
 ﻿#pragma once
-#include <unordered_map>
+#include "CacheLine.h"
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <mutex>
+#include <atomic>
+#include <memory>
+
+// Page identity packed into 64 bits: owner pid in the high bits, page number in the low 24
+using PageKey = uint64_t;
+constexpr PageKey NO_PAGE = UINT64_MAX;
+inline PageKey makePageKey(uint64_t pid, int page) { return (pid << 24) | (static_cast<uint64_t>(page) & 0xFFFFFF); }
+inline uint64_t pageKeyPid(PageKey key) { return key >> 24; }
+inline int pageKeyPage(PageKey key) { return static_cast<int>(key & 0xFFFFFF); }
 
 class MainMemory {
 public:
-    MainMemory(int totalBytes, int frameSize);
+    static constexpr int DEFAULT_LOCK_STRIPES = 64;
+
+    // lockStripes = 1 puts every frame behind a single lock
+    MainMemory(int totalBytes, int frameSize, int lockStripes = DEFAULT_LOCK_STRIPES);
 
     int getTotalFrames() const;
-    int getFreeFrameIndex() const;
-    bool isFrameValid(int frameIndex) const;
-    void setFrame(int index, const std::string& pageId);
+    int allocateFrame(); // Claims a free frame and returns its index, or -1 if memory is full
+    void setFrame(int index, PageKey page);
     void clearFrame(int index);
-    void markFrameValid(int index);
-    void markFrameInvalid(int index);
-    std::string getPageAtFrame(int index) const;
+    PageKey getPageAtFrame(int index) const;
 
-    void writeMemory(const std::string& address, uint16_t value);
-    uint16_t readMemory(const std::string& address) const;
-    bool addressExists(const std::string& address) const;
+    // Physical memory is word-addressed: byte address A maps to word A / 2.
+    void write(int physicalAddr, uint16_t value);
+    uint16_t read(int physicalAddr) const;
+
+    // Holds the lock guarding frame `frameIndex`'s contents, for callers that must keep the
+    // frame steady across more than one step. The _unlocked accessors expect it to be held.
+    std::unique_lock<std::mutex> lockFrame(int frameIndex) const;
+    void write_unlocked(int physicalAddr, uint16_t value);
+    uint16_t read_unlocked(int physicalAddr) const;
+    std::vector<uint16_t> dumpPageFromFrame_unlocked(int frameIndex) const;
 
-    std::unordered_map<std::string, uint16_t>& getMemoryMap();
-    const std::vector<std::string>& getFrameTable() const;
-    const std::vector<bool>& getValidBits() const;
+    // Whether a hex-string address (e.g. "0x1A0") falls inside physical memory
+    bool addressExists(const std::string& address) const;
 
-    std::vector<int> freeFramesByPagePrefix(const std::string& prefix);
+    // Copy of the frame table taken under the lock
+    std::vector<PageKey> getFrameTable() const;
 
-    std::vector<uint16_t> dumpPageFromFrame(int frameIndex, const std::string& baseAddress);
-    void loadPageToFrame(int frameIndex, const std::vector<uint16_t>& data, const std::string& baseAddress);
+    void loadPageToFrame(int frameIndex, const std::vector<uint16_t>& data);
+    void zeroFrame(int frameIndex);
 
-    int getUsedFrames() const;
-    int getFreeFrames() const;
+    // Lock-free; maintained as frames are claimed and released
+    int getUsedFrames() const { return usedFrames_.load(std::memory_order_relaxed); }
+    int getFreeFrames() const { return totalFrames - getUsedFrames(); }
     int getTotalMemoryBytes() const { return totalMemoryBytes; }
     int getFrameSize() const { return frameSize; }
 
@@ -41,15 +58,36 @@ private:
     int frameSize;
     int totalFrames;
 
-    std::unordered_map<std::string, uint16_t> memory;
-    std::vector<std::string> frameTable;
-    std::vector<bool> validBits;
+    int wordsPerFrame;
+
+    std::vector<uint16_t> words;
+    std::vector<PageKey> frameTable;
 
+    // One bit per frame, set while the frame is free; searched a 64-bit word at a time
+    std::vector<uint64_t> freeBitmap_;
+    int searchHint_ = 0; // word to start the next free-frame search from
+    std::atomic<int> usedFrames_{ 0 };
+
+    // Guards the frame table and the free bitmap
     mutable std::mutex memoryMutex_;
 
+    // Frame contents are guarded by striped locks, frame f by stripe f % stripeCount_, so
+    // cores working in different frames do not wait on each other. A full line of padding
+    // after each lock keeps neighbouring locks off each other's cache lines.
+    struct LockStripe {
+        std::mutex mutex;
+        char pad[CACHE_LINE_BYTES];
+    };
+    std::unique_ptr<LockStripe[]> stripes_;
+    int stripeCount_;
+    std::mutex& frameLock(int frameIndex) const { return stripes_[frameIndex % stripeCount_].mutex; }
+
+    bool _isFree_unlocked(int index) const;
+    void _claimFrame_unlocked(int index);
+    void _releaseFrame_unlocked(int index);
     void _clearFrame_unlocked(int index);
-    void _writeMemory_unlocked(const std::string& address, uint16_t value);
-    uint16_t _readMemory_unlocked(const std::string& address) const;
+    void _writeMemory_unlocked(int physicalAddr, uint16_t value);
+    uint16_t _readMemory_unlocked(int physicalAddr) const;
+    static int _parseAddress(const std::string& address);
     int _getFreeFrameIndex_unlocked() const;
-    int _getUsedFrames_unlocked() const;
 };
\ No newline at end of file
@@ -1,16 +1,34 @@
 #include "MemoryManager.h"
 #include "Process.h"
 #include "Scheduler.h"
+#include "GlobalState.h"
+#include "CoreStats.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <random>
 #include <stdexcept>
+#include <thread>
 
-MemoryManager::MemoryManager(MainMemory& mem, int minMemProc, int maxMemProc, int frameSz)
+thread_local TLB* MemoryManager::threadTlb_ = nullptr;
+
+static std::random_device memory_rd;
+static std::mt19937 memory_gen(memory_rd());
+
+void MemoryManager::seedRandom(uint32_t seed) {
+    memory_gen.seed(seed);
+}
+
+MemoryManager::MemoryManager(MainMemory& mem, int minMemProc, int maxMemProc, int frameSz,
+    const std::string& replacementPolicy, BackingStoreLog::SyncPolicy backingStoreSync, size_t compressedPoolBytes)
     : memory(mem), minMemPerProc(minMemProc), maxMemPerProc(maxMemProc), frameSize(frameSz),
-    pagedInCount(0), pagedOutCount(0), nextPageId(0), scheduler_(nullptr) { // Initialize scheduler_ to nullptr
+    nextPageId(0),
+    swap_(SWAP_FILE_PATH, frameSz / 2), swapPool_(swap_, frameSz / 2, compressedPoolBytes), evictionLog_(BACKING_STORE_LOG_PATH, frameSz / 2, backingStoreSync),
+    frames_(mem.getTotalFrames()), policy_(ReplacementPolicy::create(replacementPolicy, mem.getTotalFrames())) {
+    if (!policy_) {
+        policy_ = ReplacementPolicy::create("fifo", mem.getTotalFrames());
+    }
 }
 
 void MemoryManager::setScheduler(Scheduler* sched) {
@@ -20,29 +38,19 @@ void MemoryManager::setScheduler(Scheduler* sched) {
 bool MemoryManager::allocateMemory(std::shared_ptr<Process> process, int requestedBytes) {
     int pages_required = (requestedBytes + frameSize - 1) / frameSize;
 
+    process->initPageTable(pages_required);
     process->setAllocatedMemory(requestedBytes);
 
     {
-        std::lock_guard<std::mutex> lock(process->getPageTableMutex());
-        for (int i = 0; i < pages_required; ++i) {
-            process->getPageTable()[i] = -1;
-            process->getValidBits()[i] = false; 
-        }
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        processFrames_[process->getPid()].owner = process;
     }
 
-    // Lock the backing store mutex to create the pages
-    {
-        std::lock_guard<std::mutex> lock(backingStoreMutex_);
-        for (int i = 0; i < pages_required; ++i) {
-            std::stringstream ss;
-            ss << "p" << process->getPid() << "_page" << i;
-            std::string pageId = ss.str();
-            std::vector<uint16_t> zeroPage(frameSize / 2, 0);
-            backingStore_[pageId] = zeroPage; // Pages are "stored" in the backingStore_ map by default
-        }
-    }
+    // Pages get no storage up front: the first fault maps a zeroed frame, and a swap slot
+    // is only taken when a dirty page is evicted
+    swapPool_.addProcess(process->getPid());
 
-    return true; // Always succeed if virtual allocation and backing store setup is complete
+    return true; // Always succeed if virtual allocation is complete
 }
 
 int MemoryManager::getRandomMemorySize() const {
@@ -58,33 +66,27 @@ int MemoryManager::getRandomMemorySize() const {
         return minMemPerProc;
     }
 
-   
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(0, static_cast<int>(powerOfTwoSizes.size()) - 1);
 
-    return powerOfTwoSizes[dist(gen)];
+    return powerOfTwoSizes[dist(memory_gen)];
 }
 
-std::string MemoryManager::allocateVariable(std::shared_ptr<Process> process, const std::string& varName) {
-    // Check if symbol table is full (max 32 variables * 2 bytes/variable = 64 bytes)
-    if (process->getSymbolTable().size() * 2 >= 64) { // 
-        return ""; // Cannot allocate more variables 
+// Binds a variable slot to the next word of the symbol table segment and returns its
+// logical address, or -1 if the segment is full. Redeclaring a variable keeps its address.
+int MemoryManager::allocateVariable(const std::shared_ptr<Process>& process, int slot) {
+    int address = process->getVariableAddress(slot);
+    if (address < 0) {
+        // Check if symbol table is full (max 32 variables * 2 bytes/variable = 64 bytes)
+        int declared = process->getDeclaredVariableCount();
+        if (declared >= Process::MAX_VARIABLES) {
+            return -1; // Cannot allocate more variables
+        }
+        // Logical address is just the offset within the symbol table segment
+        address = declared * 2;
+        process->bindVariable(slot, address);
     }
-
-    // The logical address for a variable starts from 0x0 within the process's memory space.
-    // The offset is based on the current size of the symbol table * 2 (for uint16_t).
-    uint16_t currentOffsetInSymbolTable = static_cast<uint16_t>(process->getSymbolTable().size() * 2);
-
-    std::stringstream ss;
-    ss << "0x" << std::hex << std::uppercase << currentOffsetInSymbolTable; // Logical address is just the offset within the symbol table segment
-
-    std::string address = ss.str();
-    process->getSymbolTable()[varName] = address;
     // When a variable is declared, its initial value is 0 unless specified.
-    // The problem implies initial value 0 for uninitialized blocks, but for DECLARE with a value, it's set.
-    // For allocateVariable, which is called by DECLARE without an explicit value, 0 is appropriate.
-    write(address, 0, process); // Write 0 to the newly allocated variable's memory location
+    write(address, 0, process);
     return address;
 }
 
@@ -92,139 +94,233 @@ bool MemoryManager::isAddressInMemory(const std::string& addr) {
     return memory.addressExists(addr);
 }
 
+// Frees every frame the process still has resident and invalidates the pages they backed;
+// O(resident pages).
 void MemoryManager::deallocate(uint64_t pid) {
-    std::string prefix = "p" + std::to_string(pid) + "_page";
-
-    // This now atomically frees frames and tells us which ones were freed.
-    std::vector<int> freedFrames = memory.freeFramesByPagePrefix(prefix);
-    if (freedFrames.empty()) {
+    std::lock_guard<std::mutex> lock(frameMutex_);
+    auto it = processFrames_.find(pid);
+    if (it == processFrames_.end()) {
         return; // Nothing was deallocated, so nothing to clean up.
     }
 
-    // Use a set for fast lookups of the frames we need to remove.
-    std::unordered_set<int> freedFramesSet(freedFrames.begin(), freedFrames.end());
-
-    // Atomically rebuild the FIFO queue without the stale entries.
-    std::lock_guard<std::mutex> lock(fifoQueueMutex_);
-    std::queue<int> new_fifo_queue;
-    while (!frame_fifo_queue_.empty()) {
-        int frameIndex = frame_fifo_queue_.front();
-        frame_fifo_queue_.pop();
-
-        // Only keep frames that were NOT in the set of frames we just freed.
-        if (freedFramesSet.find(frameIndex) == freedFramesSet.end()) {
-            new_fifo_queue.push(frameIndex);
-        }
+    int frame = it->second.residentHead;
+    while (frame != -1) {
+        const FrameDescriptor& d = frames_[frame];
+        int next = d.residentNext;
+        d.owner->clearPteFlags(d.page, PageTableEntry::VALID);
+        unlinkFrame_unlocked(frame);
+        memory.clearFrame(frame);
+        frame = next;
     }
-    frame_fifo_queue_ = std::move(new_fifo_queue);
+    processFrames_.erase(it);
+    tlbEpoch_.fetch_add(1, std::memory_order_release);
+    swapPool_.removeProcess(pid);
 }
 
-uint16_t MemoryManager::read(const std::string& logicalAddr, std::shared_ptr<Process> p) {
-    // Translate the logical address to a physical frame and offset.
-    std::pair<int, int> physicalLocation = translate(logicalAddr, p);
-    int frameIndex = physicalLocation.first;
-    int offset = physicalLocation.second;
-
-    // The physical address is the base of the frame plus the offset.
-    int physicalByteAddress = frameIndex * frameSize + offset;
-
-    // Convert the physical byte address to the hex string key used by MainMemory.
-    std::stringstream ss;
-    ss << "0x" << std::hex << std::uppercase << physicalByteAddress;
+bool MemoryManager::isRegistered(uint64_t pid) {
+    std::lock_guard<std::mutex> lock(frameMutex_);
+    return processFrames_.count(pid) != 0;
+}
 
-    return memory.readMemory(ss.str());
+// Hands the frame to the replacement policy and adds it to the owner's resident list.
+// Returns false, linking nothing, if the owner is not registered (never allocated, or
+// already deallocated). Caller holds frameMutex_.
+bool MemoryManager::linkFrame_unlocked(int frame, Process* owner, int page) {
+    auto registration = processFrames_.find(owner->getPid());
+    if (registration == processFrames_.end()) return false;
+
+    FrameDescriptor& d = frames_[frame];
+    d.resident = true;
+    d.pid = owner->getPid();
+    d.page = page;
+    d.owner = owner;
+
+    policy_->onLoad(frame, cpuClock.now());
+
+    int& head = registration->second.residentHead;
+    d.residentPrev = -1;
+    d.residentNext = head;
+    if (head != -1) frames_[head].residentPrev = frame;
+    head = frame;
+    return true;
 }
 
-void MemoryManager::write(const std::string& logicalAddr, uint16_t value, std::shared_ptr<Process> p) {
-    // Translate the logical address to a physical frame and offset.
-    std::pair<int, int> physicalLocation = translate(logicalAddr, p);
-    int frameIndex = physicalLocation.first;
-    int offset = physicalLocation.second;
+// Takes the frame away from the policy and the owner's resident list if it is resident.
+// Caller holds frameMutex_.
+void MemoryManager::unlinkFrame_unlocked(int frame) {
+    FrameDescriptor& d = frames_[frame];
+    if (!d.resident) return;
 
-    // The physical address is the base of the frame plus the offset.
-    int physicalByteAddress = frameIndex * frameSize + offset;
+    policy_->onRemove(frame);
 
-    // Convert the physical byte address to the hex string key used by MainMemory.
-    std::stringstream ss;
-    ss << "0x" << std::hex << std::uppercase << physicalByteAddress;
+    if (d.residentPrev != -1) {
+        frames_[d.residentPrev].residentNext = d.residentNext;
+    }
+    else {
+        auto it = processFrames_.find(d.pid);
+        if (it != processFrames_.end()) it->second.residentHead = d.residentNext;
+    }
+    if (d.residentNext != -1) frames_[d.residentNext].residentPrev = d.residentPrev;
 
-    memory.writeMemory(ss.str(), value);
+    d = FrameDescriptor();
 }
 
-std::pair<int, int> MemoryManager::translate(std::string logicalAddr, std::shared_ptr<Process> p) {
-    int addr = 0;
+int MemoryManager::parseAddress(const std::string& addr) {
     try {
-        addr = std::stoi(logicalAddr, nullptr, 16);
+        return std::stoi(addr, nullptr, 16);
     }
     catch (...) {
-        p->setTerminationReason(Process::TerminationReason::MEMORY_VIOLATION, logicalAddr);
-        throw std::runtime_error("Invalid memory address format.");
+        return -1;
     }
+}
 
+std::string MemoryManager::formatAddress(int addr) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::uppercase << addr;
+    return ss.str();
+}
+
+uint16_t MemoryManager::read(int logicalAddr, const std::shared_ptr<Process>& p) {
+    std::unique_lock<std::mutex> pin;
+    int physical = pinPage(logicalAddr, p, false, pin);
+    return physical < 0 ? 0 : memory.read_unlocked(physical);
+}
+
+void MemoryManager::write(int logicalAddr, uint16_t value, const std::shared_ptr<Process>& p) {
+    std::unique_lock<std::mutex> pin;
+    int physical = pinPage(logicalAddr, p, true, pin);
+    if (physical >= 0) memory.write_unlocked(physical, value);
+}
+
+uint16_t MemoryManager::read(const std::string& logicalAddr, const std::shared_ptr<Process>& p) {
+    return read(checkedAddress(logicalAddr, p), p);
+}
+
+void MemoryManager::write(const std::string& logicalAddr, uint16_t value, const std::shared_ptr<Process>& p) {
+    write(checkedAddress(logicalAddr, p), value, p);
+}
+
+// Translates the address and locks the frame behind it, returning the physical address with
+// `pin` holding the frame's lock, or -1 with nothing locked. The translation may be stale by
+// the time the lock is taken, so the page table entry is checked again under it. evictPage
+// invalidates the entry under the same lock, so a pinned access finishes before the frame
+// is dumped or handed to another page.
+int MemoryManager::pinPage(int logicalAddr, const std::shared_ptr<Process>& p, bool isWrite, std::unique_lock<std::mutex>& pin) {
+    int pageNum = logicalAddr / frameSize;
+    for (;;) {
+        int physical = translate(logicalAddr, p);
+        if (physical < 0) return -1;
+
+        int frame = physical / frameSize;
+        pin = memory.lockFrame(frame);
+        uint32_t pte = p->loadPte(pageNum);
+        if ((pte & PageTableEntry::VALID) && PageTableEntry::frame(pte) == frame) {
+            // The access marks the live entry, not the TLB's copy of it. Clearing REFERENCED
+            // then needs no TLB flush, and a write to a page that was written back and
+            // faulted into the same frame again is not dropped later as clean.
+            uint32_t flags = isWrite ? (PageTableEntry::REFERENCED | PageTableEntry::DIRTY) : PageTableEntry::REFERENCED;
+            if ((pte & flags) != flags) p->setPteFlags(pageNum, flags);
+            return physical;
+        }
+        pin.unlock();
+        // The translation came from a TLB entry for a page that has since been evicted
+        if (TLB* tlb = threadTlb_) tlb->invalidate(p->getPid(), pageNum);
+    }
+}
+
+// Returns the physical byte address backing a logical address, faulting the page in if needed.
+// The referenced and dirty bits are left to pinPage, which sees the live entry.
+int MemoryManager::translate(int addr, const std::shared_ptr<Process>& p) {
     if (addr < 0 || (addr + 1) >= p->getAllocatedMemory()) {
-        p->setTerminationReason(Process::TerminationReason::MEMORY_VIOLATION, logicalAddr);
+        p->setTerminationReason(Process::TerminationReason::MEMORY_VIOLATION, formatAddress(addr));
         throw std::runtime_error("Memory Access Violation");
     }
 
     int pageNum = addr / frameSize;
     int offset = addr % frameSize;
-    bool needs_fault = false;
 
-    {
-        std::lock_guard<std::mutex> lock(p->getPageTableMutex());
-        if (p->getValidBits().count(pageNum) == 0 || !p->getValidBits().at(pageNum)) {
-            needs_fault = true;
+    TLB* tlb = threadTlb_;
+    uint32_t pte = 0;
+    if (tlb) {
+        pte = tlb->lookup(p->getPid(), pageNum, tlbEpoch_.load(std::memory_order_acquire));
+    }
+    bool cached = pte != 0;
+
+    if (!cached) {
+        pte = p->loadPte(pageNum);
+        while (!(pte & PageTableEntry::VALID)) {
+            if (!handlePageFault(p, pageNum)) {
+                // A deallocated process has no memory any more: reads see 0 and writes go
+                // nowhere. Otherwise every frame is claimed by faults in flight on other
+                // cores, and one comes free once they map their pages.
+                if (!isRegistered(p->getPid())) return -1;
+                std::this_thread::yield();
+            }
+            pte = p->loadPte(pageNum);
         }
     }
 
-    if (needs_fault) {
-        handlePageFault(p, pageNum);
+    if (tlb && !cached) {
+        tlb->insert(p->getPid(), pageNum, pte);
     }
+    return PageTableEntry::frame(pte) * frameSize + offset;
+}
 
-    std::lock_guard<std::mutex> lock(p->getPageTableMutex());
-    int frameIndex = p->getPageTable().at(pageNum);
-    return { frameIndex, offset };
+int MemoryManager::checkedAddress(const std::string& logicalAddr, const std::shared_ptr<Process>& p) {
+    int addr = parseAddress(logicalAddr);
+    if (addr < 0) {
+        p->setTerminationReason(Process::TerminationReason::MEMORY_VIOLATION, logicalAddr);
+        throw std::runtime_error(addr == -1 ? "Invalid memory address format." : "Memory Access Violation");
+    }
+    return addr;
 }
 
 bool MemoryManager::handlePageFault(std::shared_ptr<Process> p, int pageNum) {
-    std::stringstream ss_pageId;
-    ss_pageId << "p" << p->getPid() << "_page" << pageNum;
-    std::string pageId = ss_pageId.str();
+    PageKey pageKey = makePageKey(p->getPid(), pageNum);
+    if (CoreStats* stats = CoreStats::forThread()) CoreStats::add(stats->pageFaults, 1);
+
+    // The page may have been invalidated by an eviction that hasn't stored its copy yet;
+    // until it sets SWAPPED, the page would look never written and be zero-filled
+    {
+        std::unique_lock<std::mutex> lock(frameMutex_);
+        evictionDone_.wait(lock, [&] { return evicting_.count(pageKey) == 0; });
+    }
 
-    int frameIndex = memory.getFreeFrameIndex();
+    int frameIndex = memory.allocateFrame();
     if (frameIndex == -1) {
-        int victimFrame = getVictimFrame_FIFO();
+        int victimFrame = selectVictimFrame();
         if (victimFrame != -1) {
-            evictPage(victimFrame);
+            // The victim stays claimed throughout, so no other fault can allocate it
+            evictPage(victimFrame, true);
             frameIndex = victimFrame;
         }
     }
 
     if (frameIndex != -1) {
-        std::stringstream ss_baseAddr;
-        ss_baseAddr << "0x" << std::hex << (frameIndex * frameSize);
-        std::string baseAddr = ss_baseAddr.str();
-
-        {
-            std::lock_guard<std::mutex> lock(backingStoreMutex_);
-            if (backingStore_.count(pageId)) {
-                memory.loadPageToFrame(frameIndex, backingStore_[pageId], baseAddr);
-            }
+        uint32_t swapped = p->loadPte(pageNum) & PageTableEntry::SWAPPED;
+        std::vector<uint16_t> pageData(frameSize / 2);
+        if (swapped && swapPool_.load(p->getPid(), pageNum, pageData.data())) {
+            memory.loadPageToFrame(frameIndex, pageData);
         }
-        {
-            std::lock_guard<std::mutex> lock(p->getPageTableMutex());
-            memory.setFrame(frameIndex, pageId);
-            memory.markFrameValid(frameIndex);
-            p->getPageTable()[pageNum] = frameIndex;
-            p->getValidBits()[pageNum] = true;
+        else {
+            memory.zeroFrame(frameIndex);
         }
+        memory.setFrame(frameIndex, pageKey);
+        p->storePte(pageNum, PageTableEntry::make(frameIndex) | swapped);
 
+        bool linked;
         {
-            std::lock_guard<std::mutex> lock(fifoQueueMutex_);
-            frame_fifo_queue_.push(frameIndex);
+            std::lock_guard<std::mutex> lock(frameMutex_);
+            linked = linkFrame_unlocked(frameIndex, p.get(), pageNum);
+        }
+        if (!linked) {
+            // Deallocated while faulting; nothing would ever free the frame
+            p->storePte(pageNum, swapped);
+            memory.clearFrame(frameIndex);
+            return false;
         }
 
-        ++pagedInCount;
+        pagedInCount.add();
         return true; // Page fault was successfully handled.
     }
     return false; // Return false to indicate failure.
@@ -233,161 +329,220 @@ bool MemoryManager::handlePageFault(std::shared_ptr<Process> p, int pageNum) {
 void MemoryManager::preloadPages(std::shared_ptr<Process> process, int startPage, int numPages) {
     for (int i = 0; i < numPages; ++i) {
         int pageNum = startPage + i;
-        if (process->getValidBits().count(pageNum) == 0 || !process->getValidBits().at(pageNum)) {
+        if (pageNum < process->getPageCount() && !(process->loadPte(pageNum) & PageTableEntry::VALID)) {
             handlePageFault(process, pageNum);
         }
     }
 }
 
-void MemoryManager::evictPage(int index) {
-    std::string pageId = memory.getPageAtFrame(index);
-    if (pageId.empty()) return;
-
-    uint64_t ownerPid = -1;
-    int pageNum = -1;
-    std::shared_ptr<Process> ownerProcess = nullptr; 
-    size_t p_pos = pageId.find('p');
-    size_t page_pos = pageId.find("_page");
-    if (p_pos != std::string::npos && page_pos != std::string::npos) {
-        ownerPid = std::stoull(pageId.substr(p_pos + 1, page_pos - (p_pos + 1)));
-        pageNum = std::stoi(pageId.substr(page_pos + 5));
+// With `reuse`, the frame is emptied but stays claimed for the caller to map a new page into;
+// otherwise it goes back to the free frames.
+void MemoryManager::evictPage(int index, bool reuse) {
+    PageKey pageKey = memory.getPageAtFrame(index);
+    if (pageKey == NO_PAGE) return;
+
+    int pageNum = pageKeyPage(pageKey);
+    std::shared_ptr<Process> ownerProcess = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        unlinkFrame_unlocked(index);
+        evicting_.insert(pageKey);
+        auto it = processFrames_.find(pageKeyPid(pageKey));
+        if (it != processFrames_.end()) ownerProcess = it->second.owner.lock();
     }
 
-    if (ownerPid != -1 && pageNum != -1 && scheduler_) {
-        ownerProcess = scheduler_->findProcessById(ownerPid); 
-        if (ownerProcess) {
-            std::lock_guard<std::mutex> lock(ownerProcess->getPageTableMutex());
-            ownerProcess->getValidBits()[pageNum] = false;
+    // Without an owner there is no dirty bit to go by, so the page is written back
+    bool dirty = true;
+    std::vector<uint16_t> data;
+    {
+        // Accesses pin the frame under this lock and recheck the entry, so once it is invalid
+        // here nothing is still writing into the frame and the dirty bit is final
+        std::unique_lock<std::mutex> pin = memory.lockFrame(index);
+        if (ownerProcess && pageNum < ownerProcess->getPageCount()) {
+            uint32_t pte = ownerProcess->clearPteFlags(pageNum, PageTableEntry::VALID | PageTableEntry::DIRTY);
+            dirty = (pte & PageTableEntry::DIRTY) != 0;
         }
+        if (dirty) data = memory.dumpPageFromFrame_unlocked(index);
+    }
+    // No TLB shootdown: a core still caching this page finds the entry stale in pinPage and
+    // drops just that entry
+
+    // A page that was only read since it was loaded still matches its swap copy, or is
+    // still all zeros if it never had one. Every write sets DIRTY under the frame lock
+    // before it lands, so a clean page here has no write in flight.
+    if (!dirty) {
+        finishEviction(pageKey);
+        releaseFrame(index, reuse);
+        writeBacksAvoided_.add();
+        pagedOutCount.add();
+        return;
     }
 
-    std::stringstream ss_baseAddr;
-    ss_baseAddr << "0x" << std::hex << (index * frameSize);
-    std::string baseAddr = ss_baseAddr.str();
+    if (swapPool_.store(pageKeyPid(pageKey), pageNum, data.data()) && ownerProcess) {
+        ownerProcess->setPteFlags(pageNum, PageTableEntry::SWAPPED);
+    }
+    finishEviction(pageKey);
 
-    std::vector<uint16_t> data = memory.dumpPageFromFrame(index, baseAddr);
+    writeToBackingStore(pageKey, ownerProcess, index, std::move(data));
+    releaseFrame(index, reuse);
+    pagedOutCount.add();
+}
 
+// Lets faults on the page through again once its swap copy, if any, is in place.
+void MemoryManager::finishEviction(PageKey pageKey) {
     {
-        std::lock_guard<std::mutex> lock(backingStoreMutex_);
-        backingStore_[pageId] = data;
+        std::lock_guard<std::mutex> lock(frameMutex_);
+        evicting_.erase(pageKey);
     }
+    evictionDone_.notify_all();
+}
 
-    writeToBackingStore(pageId, ownerProcess, index, data); 
-    memory.clearFrame(index);
-    ++pagedOutCount;
+void MemoryManager::releaseFrame(int index, bool reuse) {
+    if (reuse) memory.setFrame(index, NO_PAGE);
+    else memory.clearFrame(index);
 }
 
-int MemoryManager::getVictimFrame_FIFO() {
-    std::lock_guard<std::mutex> lock(fifoQueueMutex_); 
+int MemoryManager::selectVictimFrame() {
+    std::lock_guard<std::mutex> lock(frameMutex_);
 
-    if (frame_fifo_queue_.empty()) {
-        return -1;
+    int victimFrame = policy_->selectVictim(*this, cpuClock.now());
+    if (victimFrame != -1) {
+        unlinkFrame_unlocked(victimFrame);
     }
-    int victimFrame = frame_fifo_queue_.front();
-    frame_fifo_queue_.pop();
     return victimFrame;
 }
 
-void MemoryManager::writeToBackingStore(const std::string& pageId, std::shared_ptr<Process> ownerProcess, int frameIndex, const std::vector<uint16_t>& pageData) {
-    std::ofstream out("csopesy-backing-store.txt", std::ios::app);
-    if (!out.is_open()) {
-        std::cerr << "Error: Could not open csopesy-backing-store.txt for writing." << std::endl;
-        return;
-    }
+uint32_t MemoryManager::pageFlags(int frame) const {
+    const FrameDescriptor& d = frames_[frame];
+    if (!d.resident) return 0;
+    return d.owner->loadPte(d.page) & (PageTableEntry::REFERENCED | PageTableEntry::DIRTY);
+}
+
+void MemoryManager::clearReferenced(int frame) {
+    const FrameDescriptor& d = frames_[frame];
+    if (!d.resident) return;
+    d.owner->clearPteFlags(d.page, PageTableEntry::REFERENCED);
+}
+
+void MemoryManager::writeToBackingStore(PageKey pageKey, const std::shared_ptr<Process>& ownerProcess, int frameIndex, std::vector<uint16_t> pageData) {
+    BackingStoreLog::Record record{};
+    record.header.evictedAt = static_cast<int64_t>(time(nullptr));
+    record.header.pid = pageKeyPid(pageKey);
+    record.header.page = pageKeyPage(pageKey);
+    record.header.frame = frameIndex;
+    record.header.variableCount = ownerProcess ? static_cast<uint32_t>(ownerProcess->getDeclaredVariableCount()) : 0;
+    record.data = std::move(pageData);
+    evictionLog_.append(std::move(record));
+}
+
+int MemoryManager::renderBackingStore(std::ostream& out) {
+    evictionLog_.flush();
+
+    int wordsPerPage = 0;
+    std::vector<BackingStoreLog::Record> records;
+    if (!BackingStoreLog::readAll(evictionLog_.getPath(), wordsPerPage, records)) return -1;
 
-    time_t now = time(nullptr);
-    tm localtm{};
+    for (const BackingStoreLog::Record& record : records) {
+        time_t evictedAt = static_cast<time_t>(record.header.evictedAt);
+        tm localtm{};
 #ifdef _WIN32
-    localtime_s(&localtm, &now);
+        localtime_s(&localtm, &evictedAt);
 #else
-    localtime_r(&now, &localtm);
+        localtime_r(&evictedAt, &localtm);
 #endif
-    char buf[64];
-    strftime(buf, sizeof(buf), "%m/%d/%Y %I:%M:%S %p", &localtm);
-
-    out << "\n+==========================================================================+\n";
-    std::string title = "BACKING STORE SNAPSHOT - " + std::string(buf);
-    int totalWidth = 74;
-    int padding = (totalWidth - static_cast<int>(title.length())) / 2;
-    out << "|" << std::string(padding, ' ') << title << std::string(totalWidth - padding - title.length(), ' ') << "|\n";
-    out << "+==========================================================================+\n\n";
-
-    uint64_t ownerPid = -1;
-    int pageNum = -1;
-    size_t p_pos = pageId.find('p');
-    size_t page_pos = pageId.find("_page");
-    if (p_pos != std::string::npos && page_pos != std::string::npos) {
-        ownerPid = std::stoull(pageId.substr(p_pos + 1, page_pos - (p_pos + 1)));
-        pageNum = std::stoi(pageId.substr(page_pos + 5));
-    }
+        char buf[64];
+        strftime(buf, sizeof(buf), "%m/%d/%Y %I:%M:%S %p", &localtm);
+
+        out << "\n+==========================================================================+\n";
+        std::string title = "BACKING STORE SNAPSHOT - " + std::string(buf);
+        int totalWidth = 74;
+        int padding = (totalWidth - static_cast<int>(title.length())) / 2;
+        out << "|" << std::string(padding, ' ') << title << std::string(totalWidth - padding - title.length(), ' ') << "|\n";
+        out << "+==========================================================================+\n\n";
+
+        uint64_t ownerPid = record.header.pid;
+        int pageNum = record.header.page;
+        const std::vector<uint16_t>& pageData = record.data;
+
+        // The log only keeps the pid; names come from the process if it is still known
+        std::shared_ptr<Process> ownerProcess;
+        {
+            std::lock_guard<std::mutex> lock(frameMutex_);
+            auto it = processFrames_.find(ownerPid);
+            if (it != processFrames_.end()) ownerProcess = it->second.owner.lock();
+        }
+        if (!ownerProcess && scheduler_) ownerProcess = scheduler_->findProcessById(ownerPid);
 
-    out << "Evicted Page        : " << pageId << "\n";
-    if (ownerProcess) {
-        out << "Owner Process       : " << ownerProcess->getName() << " (PID: " << ownerProcess->getPid() << ")\n";
-    }
-    else {
-        out << "Owner Process       : Unknown (PID: " << ownerPid << ")\n";
-    }
-    out << "Logical Page Number : " << pageNum << "\n";
-    out << "Evicted From Frame  : " << frameIndex << "\n\n";
-
-    // --- Page Data Table ---
-    out << "+----------------------------- Page Data (Hex) -----------------------------+\n";
-    out << "| Offset | Value  | Offset | Value  | Offset | Value  | Offset | Value     |\n";
-    out << "+--------+--------+--------+--------+--------+--------+--------+-----------+\n";
-
-    out << std::hex << std::uppercase << std::setfill('0');
-    for (size_t i = 0; i < pageData.size(); i += 4) {
-        for (int j = 0; j < 4; ++j) {
-            size_t idx = i + j;
-            if (idx < pageData.size()) {
-                int logicalOffset = static_cast<int>(pageNum * frameSize + idx * 2);
-                out << "| 0x" << std::setw(2) << logicalOffset
-                    << " | 0x" << std::setw(4) << pageData[idx] << " ";
-            }
-            else {
-                out << "|        |        ";
+        out << "Evicted Page        : p" << ownerPid << "_page" << pageNum << "\n";
+        if (ownerProcess) {
+            out << "Owner Process       : " << ownerProcess->getName() << " (PID: " << ownerProcess->getPid() << ")\n";
+        }
+        else {
+            out << "Owner Process       : Unknown (PID: " << ownerPid << ")\n";
+        }
+        out << "Logical Page Number : " << pageNum << "\n";
+        out << "Evicted From Frame  : " << record.header.frame << "\n\n";
+
+        // --- Page Data Table ---
+        out << "+----------------------------- Page Data (Hex) -----------------------------+\n";
+        out << "| Offset | Value  | Offset | Value  | Offset | Value  | Offset | Value     |\n";
+        out << "+--------+--------+--------+--------+--------+--------+--------+-----------+\n";
+
+        out << std::hex << std::uppercase << std::setfill('0');
+        for (size_t i = 0; i < pageData.size(); i += 4) {
+            for (int j = 0; j < 4; ++j) {
+                size_t idx = i + j;
+                if (idx < pageData.size()) {
+                    int logicalOffset = static_cast<int>(pageNum * frameSize + idx * 2);
+                    out << "| 0x" << std::setw(2) << logicalOffset
+                        << " | 0x" << std::setw(4) << pageData[idx] << " ";
+                }
+                else {
+                    out << "|        |        ";
+                }
             }
+            out << "|\n";
         }
-        out << "|\n";
-    }
-    out << "+-------------------------------------------------------------------------+\n";
-
-    // --- Symbol Table ---
-    if (pageNum == 0 && ownerProcess) {
-        out << "\nSymbol Table (Page 0):\n";
-        out << "+----------+--------------+--------+\n";
-        out << "| Variable | Logical Addr | Value  |\n";
-        out << "+----------+--------------+--------+\n";
-
-        std::lock_guard<std::mutex> lock(ownerProcess->getPageTableMutex());
-        const auto& symbolTable = ownerProcess->getSymbolTable();
-        for (const auto& pair : symbolTable) {
-            const std::string& varName = pair.first;
-            const std::string& logicalAddr = pair.second;
-            int varOffset = std::stoi(logicalAddr, nullptr, 16);
-            uint16_t varValue = 0;
-            if (varOffset >= 0 && varOffset / 2 < static_cast<int>(pageData.size())) {
-                varValue = pageData[varOffset / 2];
+        out << "+-------------------------------------------------------------------------+\n";
+
+        // --- Symbol Table ---
+        if (pageNum == 0 && ownerProcess) {
+            out << "\nSymbol Table (Page 0):\n";
+            out << "+----------+--------------+--------+\n";
+            out << "| Variable | Logical Addr | Value  |\n";
+            out << "+----------+--------------+--------+\n";
+
+            auto variables = ownerProcess->getVariables();
+            if (variables.size() > record.header.variableCount) variables.resize(record.header.variableCount);
+            for (const auto& var : variables) {
+                const std::string& varName = var.first;
+                int varOffset = var.second;
+                std::string logicalAddr = formatAddress(varOffset);
+                uint16_t varValue = 0;
+                if (varOffset >= 0 && varOffset / 2 < static_cast<int>(pageData.size())) {
+                    varValue = pageData[varOffset / 2];
+                }
+
+                out << std::setfill(' ') << "| " << std::left << std::setw(8) << varName
+                    << "| " << std::right << std::setw(12) << logicalAddr
+                    << " | 0x" << std::setfill('0') << std::setw(4) << varValue << " |\n";
             }
-
-            out << "| " << std::left << std::setw(8) << varName
-                << "| " << std::right << std::setw(12) << logicalAddr
-                << " | 0x" << std::setw(4) << varValue << " |\n";
+            out << "+----------+--------------+--------+\n";
         }
-        out << "+----------+--------------+--------+\n";
-    }
 
-    out << "===========================================================================\n";
+        out << "===========================================================================\n";
+        out << std::dec << std::setfill(' ');
+    }
+    return static_cast<int>(records.size());
 }
 
 
 void MemoryManager::logMemorySnapshot() {
     std::ofstream out("csopesy-vmstat.txt");
     out << "Frames: " << memory.getTotalFrames() << std::endl;
-    out << "Paged In: " << pagedInCount << std::endl;
-    out << "Paged Out: " << pagedOutCount << std::endl;
+    out << "Paged In: " << getPagedInCount() << std::endl;
+    out << "Paged Out: " << getPagedOutCount() << std::endl;
 }
 
-int MemoryManager::getPagedInCount() const { return pagedInCount; }
-int MemoryManager::getPagedOutCount() const { return pagedOutCount; }
+uint64_t MemoryManager::getPagedInCount() const { return pagedInCount.load(); }
+uint64_t MemoryManager::getPagedOutCount() const { return pagedOutCount.load(); }
@@ -1,61 +1,137 @@
 #pragma once
 #include "MainMemory.h"
+#include "TLB.h"
+#include "ReplacementPolicy.h"
+#include "BackingStoreLog.h"
+#include "SwapFile.h"
+#include "CompressedPool.h"
+#include "ShardedCounter.h"
+#include <atomic>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <fstream>
 #include <memory>
 #include <vector>
 #include <utility>
-#include <queue> 
 #include <mutex>
+#include <condition_variable>
 
 class Process;
 class Scheduler;
 
-class MemoryManager {
+class MemoryManager : private FrameAccess {
 public:
-    MemoryManager(MainMemory& mem, int minMemProc, int maxMemProc, int frameSz);
+    MemoryManager(MainMemory& mem, int minMemProc, int maxMemProc, int frameSz,
+        const std::string& replacementPolicy = "fifo",
+        BackingStoreLog::SyncPolicy backingStoreSync = BackingStoreLog::SyncPolicy::NEVER,
+        size_t compressedPoolBytes = 0);
+
+    static constexpr const char* BACKING_STORE_LOG_PATH = "csopesy-backing-store.bin";
+    static constexpr const char* SWAP_FILE_PATH = "csopesy-swap.bin";
 
     void setScheduler(Scheduler* sched);
 
     bool allocateMemory(std::shared_ptr<Process> process, int requestedBytes);
-    std::string allocateVariable(std::shared_ptr<Process> process, const std::string& varName);
+    int allocateVariable(const std::shared_ptr<Process>& process, int slot);
 
     bool isAddressInMemory(const std::string& addr);
-    uint16_t read(const std::string& addr, std::shared_ptr<Process> p);
-    void write(const std::string& addr, uint16_t value, std::shared_ptr<Process> p);
+    uint16_t read(int logicalAddr, const std::shared_ptr<Process>& p);
+    void write(int logicalAddr, uint16_t value, const std::shared_ptr<Process>& p);
+    uint16_t read(const std::string& addr, const std::shared_ptr<Process>& p);
+    void write(const std::string& addr, uint16_t value, const std::shared_ptr<Process>& p);
+
+    static int parseAddress(const std::string& addr);
+    static std::string formatAddress(int addr);
 
-    void evictPage(int index);
+    void evictPage(int index, bool reuse = false);
     bool handlePageFault(std::shared_ptr<Process> p, int pageNum);
-    void writeToBackingStore(const std::string& pageId, std::shared_ptr<Process> ownerProcess, int frameIndex, const std::vector<uint16_t>& pageData);
+    // Queues the evicted page on the binary eviction log; the writer thread does the I/O
+    void writeToBackingStore(PageKey page, const std::shared_ptr<Process>& ownerProcess, int frameIndex, std::vector<uint16_t> pageData);
+    // Writes every logged eviction out in readable form; returns how many, or -1 if the log can't be read
+    int renderBackingStore(std::ostream& out);
     void logMemorySnapshot();
 
-    int getPagedInCount() const;
-    int getPagedOutCount() const;
+    uint64_t getPagedInCount() const;
+    uint64_t getPagedOutCount() const;
+    uint64_t getWriteBacksAvoided() const { return writeBacksAvoided_.load(); }
+    const char* getReplacementPolicyName() const { return policy_->name(); }
+    int getSwapSlotsInUse() const { return swap_.getSlotsInUse(); }
+    int getSwapSlotCapacity() const { return swap_.getSlotCapacity(); }
+    CompressedPool::Stats getSwapPoolStats() const { return swapPool_.getStats(); }
 
     void deallocate(uint64_t  pid);
 
+    // Binds the calling thread's TLB; translations from threads without one skip the TLB
+    static void bindThreadTlb(TLB* tlb) { threadTlb_ = tlb; }
+
     void preloadPages(std::shared_ptr<Process> p, int startPage, int numPages);
     int getRandomMemorySize() const;
+    // Restarts the generator behind getRandomMemorySize, for reproducible workloads
+    static void seedRandom(uint32_t seed);
 
 private:
     MainMemory& memory;
     int minMemPerProc;
     int maxMemPerProc;
     int frameSize;
-    int pagedInCount = 0;
-    int pagedOutCount = 0;
+    // Bumped from every core's page faults, so sharded rather than one shared atomic
+    ShardedCounter pagedInCount;
+    ShardedCounter pagedOutCount;
+    ShardedCounter writeBacksAvoided_; // clean evictions that skipped the backing store
     int nextPageId = 0;
 
-    std::pair<int, int> translate(std::string logicalAddr, std::shared_ptr<Process> p);
+    int translate(int logicalAddr, const std::shared_ptr<Process>& p);
+    int pinPage(int logicalAddr, const std::shared_ptr<Process>& p, bool isWrite, std::unique_lock<std::mutex>& pin);
+    // Parses a hex logical address, terminating the process with a violation if it is malformed
+    int checkedAddress(const std::string& logicalAddr, const std::shared_ptr<Process>& p);
+
+    int selectVictimFrame();
+    void releaseFrame(int index, bool reuse);
+    void finishEviction(PageKey pageKey);
+
+    // FrameAccess, for the replacement policy; called with frameMutex_ held
+    uint32_t pageFlags(int frame) const override;
+    void clearReferenced(int frame) override;
+
+    SwapFile swap_;
+    CompressedPool swapPool_; // Evicted pages go through here, and on to swap_ if they don't fit
+    BackingStoreLog evictionLog_;
+
+    // Per-frame ownership. Resident frames are threaded onto their owner's resident list
+    // through this array and are tracked by the replacement policy.
+    struct FrameDescriptor {
+        bool resident = false;
+        uint64_t pid = 0;
+        int page = -1;
+        Process* owner = nullptr; // Valid while resident: deallocate unlinks a process's frames first
+        int residentPrev = -1;
+        int residentNext = -1;
+    };
+
+    bool isRegistered(uint64_t pid);
+    bool linkFrame_unlocked(int frame, Process* owner, int page);
+    void unlinkFrame_unlocked(int frame);
 
-    int getVictimFrame_FIFO();
+    std::vector<FrameDescriptor> frames_;
+    std::unique_ptr<ReplacementPolicy> policy_;
 
-    std::unordered_map<std::string, std::vector<uint16_t>> backingStore_;
-    std::mutex backingStoreMutex_;
+    // Registered by allocateMemory and dropped by deallocate, so eviction finds a frame's
+    // owner by pid without searching the scheduler's process lists
+    struct ProcessFrames {
+        std::weak_ptr<Process> owner;
+        int residentHead = -1;
+    };
+    std::unordered_map<uint64_t, ProcessFrames> processFrames_;
+    std::mutex frameMutex_;
+    // Pages evictPage has invalidated but not yet stored; faults on them wait on evictionDone_
+    std::unordered_set<PageKey> evicting_;
+    std::condition_variable evictionDone_;
 
-    std::queue<int> frame_fifo_queue_;
-    std::mutex fifoQueueMutex_;
+    // Bumped when a process's memory is freed; every TLB flushes when it sees a new epoch.
+    // Evictions don't bump it: pinPage drops stale entries one at a time as it meets them.
+    std::atomic<uint64_t> tlbEpoch_{ 0 };
+    static thread_local TLB* threadTlb_;
 
-    Scheduler* scheduler_;
+    Scheduler* scheduler_ = nullptr;
 };
\ No newline at end of file
@@ -20,28 +20,28 @@
 static std::random_device rd;
 static std::mt19937 gen(rd());
 
+void Process::seedRandom(uint32_t seed) {
+    gen.seed(seed);
+}
+
 // Constructor for the Process class
 Process::Process(uint64_t pid, std::string name, MemoryManager* memManager)
     : pid_(pid), name_(std::move(name)), finished_(false), isSleeping_(false), sleepTargetTick_(0), memoryManager_(memManager),
     terminationReason_(TerminationReason::RUNNING), allocatedMemoryBytes_(0), violationTime_(0), hasBeenScheduled_(false) {
 }
 
-// Executes a single instruction depending on opcode type
-bool Process::execute(const Instruction& ins, int coreId) {
-    auto getValue = [this](const std::string& token) -> uint16_t {
-        if (isdigit(token[0]) || (token[0] == '-' && token.size() > 1)) {
-            try { return static_cast<uint16_t>(std::stoi(token)); }
-            catch (const std::out_of_range&) { return 0; }
+// Executes a single compiled instruction depending on opcode type
+bool Process::execute(const CompiledInstruction& ins, int coreId) {
+    std::shared_ptr<Process> self = shared_from_this();
+
+    auto getValue = [this, &self](OperandKind kind, int32_t value) -> uint16_t {
+        if (kind == OperandKind::IMMEDIATE) {
+            return static_cast<uint16_t>(value);
         }
-        else {
-            if (symbolTable_.count(token)) {
-                const std::string& address = symbolTable_.at(token);
-                if (memoryManager_) {
-                    return memoryManager_->read(address, shared_from_this());
-                }
-            }
-            return 0;
+        if (kind == OperandKind::VARIABLE && slotAddress_[value] >= 0 && memoryManager_) {
+            return memoryManager_->read(slotAddress_[value], self);
         }
+        return 0;
         };
 
     auto clamp = [](int64_t val) -> uint16_t {
@@ -50,97 +50,93 @@ bool Process::execute(const Instruction& ins, int coreId) {
         return static_cast<uint16_t>(val);
         };
 
-    try { // Use a try-catch block to handle exceptions from memory access
-        if (ins.opcode == 1 && ins.args.size() >= 1) { // DECLARE
-            const std::string& varName = ins.args[0];
-
-            if (symbolTable_.size() * 2 < allocatedMemoryBytes_) {
-                std::string logicalAddress = memoryManager_->allocateVariable(shared_from_this(), varName);
-
-                if (!logicalAddress.empty()) {
-                    if (ins.args.size() == 2) {
-                        uint16_t initialValue = clamp(getValue(ins.args[1]));
-                        if (memoryManager_) memoryManager_->write(logicalAddress, initialValue, shared_from_this());
-                    }
-                }
-                else {
-                    std::lock_guard<std::mutex> lock(logsMutex_);
-                    logs_.emplace_back(time(nullptr), "[Warning] Cannot declare '" + varName + "'. Memory allocation failed.");
-                }
-            }
-            else {
-                std::lock_guard<std::mutex> lock(logsMutex_);
-                logs_.emplace_back(time(nullptr), "[Warning] Process memory full. DECLARE for '" + varName + "' ignored.");
+    // Declares the variable in `slot` if it is not yet declared; returns false if there was no room
+    auto declare = [this, &self](int slot, const char* instructionName) -> bool {
+        const std::string& varName = slotNames_[slot];
+        if (slotAddress_[slot] >= 0 || getDeclaredVariableCount() * 2 < allocatedMemoryBytes_) {
+            if (memoryManager_->allocateVariable(self, slot) >= 0) {
+                return true;
             }
+            std::lock_guard<std::mutex> lock(logsMutex_);
+            logs_.emplace_back(time(nullptr), "[Warning] Cannot declare '" + varName + "'. Memory allocation failed.");
         }
-        else if (ins.opcode == 2 && ins.args.size() == 3) { // ADD
-            const std::string& destVar = ins.args[0];
-            uint16_t a = getValue(ins.args[1]);
-            uint16_t b = getValue(ins.args[2]);
-            if (symbolTable_.count(destVar) && memoryManager_) {
-                const std::string& destAddr = symbolTable_.at(destVar);
-                memoryManager_->write(destAddr, clamp(static_cast<int64_t>(a) + static_cast<int64_t>(b)), shared_from_this());
+        else {
+            std::lock_guard<std::mutex> lock(logsMutex_);
+            logs_.emplace_back(time(nullptr), "[Warning] Process memory full. " + std::string(instructionName) + " for '" + varName + "' ignored.");
+        }
+        return false;
+        };
+
+    auto readAddress = [this, &self](OperandKind kind, int32_t value) -> uint16_t {
+        if (kind == OperandKind::ADDRESS) return memoryManager_->read(value, self);
+        return memoryManager_->read(stringPool_[value], self);
+        };
+
+    auto writeAddress = [this, &self](OperandKind kind, int32_t value, uint16_t data) {
+        if (kind == OperandKind::ADDRESS) memoryManager_->write(value, data, self);
+        else memoryManager_->write(stringPool_[value], data, self);
+        };
+
+    try { // Use a try-catch block to handle exceptions from memory access
+        switch (ins.opcode) {
+        case 1: { // DECLARE
+            if (declare(ins.value[0], "DECLARE") && ins.kind[1] != OperandKind::NONE) {
+                uint16_t initialValue = clamp(getValue(ins.kind[1], ins.value[1]));
+                memoryManager_->write(slotAddress_[ins.value[0]], initialValue, self);
             }
+            break;
         }
-        else if (ins.opcode == 3 && ins.args.size() == 3) { // SUB
-            const std::string& destVar = ins.args[0];
-            uint16_t a = getValue(ins.args[1]);
-            uint16_t b = getValue(ins.args[2]);
-            if (symbolTable_.count(destVar) && memoryManager_) {
-                const std::string& destAddr = symbolTable_.at(destVar);
-                memoryManager_->write(destAddr, clamp(static_cast<int64_t>(a) - static_cast<int64_t>(b)), shared_from_this());
+        case 2:   // ADD
+        case 3: { // SUB
+            uint16_t a = getValue(ins.kind[1], ins.value[1]);
+            uint16_t b = getValue(ins.kind[2], ins.value[2]);
+            int destAddr = slotAddress_[ins.value[0]];
+            if (destAddr >= 0 && memoryManager_) {
+                int64_t result = (ins.opcode == 2)
+                    ? static_cast<int64_t>(a) + static_cast<int64_t>(b)
+                    : static_cast<int64_t>(a) - static_cast<int64_t>(b);
+                memoryManager_->write(destAddr, clamp(result), self);
             }
+            break;
         }
-        else if (ins.opcode == 4) { // PRINT
+        case 4: { // PRINT
             std::string output_message;
-            auto stripAndTrim = [](std::string s) {
-                size_t first = s.find_first_not_of(" \t\n\r");
-                if (std::string::npos == first) s.clear();
-                else s = s.substr(first, (s.find_last_not_of(" \t\n\r") - first + 1));
-                if (s.length() >= 2 && s.front() == '"' && s.back() == '"') {
-                    return s.substr(1, s.length() - 2);
-                }
-                return s;
-                };
-
-            if (!ins.args.empty()) {
-                std::string full_print_argument = ins.args[0];
-                std::stringstream arg_splitter(full_print_argument);
-                std::string part;
-                while (std::getline(arg_splitter, part, '+')) {
-                    std::string processed_part = stripAndTrim(part);
-                    if (!processed_part.empty()) {
-                        if (symbolTable_.count(processed_part)) {
-                            uint16_t varValue = getValue(processed_part);
-                            output_message += std::to_string(varValue);
-                        }
-                        else {
-                            output_message += processed_part;
-                        }
+            if (ins.kind[0] == OperandKind::PRINT_FORMAT) {
+                for (const PrintPart& part : printFormats_[ins.value[0]]) {
+                    if (part.slot >= 0 && slotAddress_[part.slot] >= 0) {
+                        output_message += std::to_string(getValue(OperandKind::VARIABLE, part.slot));
+                    }
+                    else {
+                        output_message += part.text;
                     }
                 }
             }
             std::lock_guard<std::mutex> lock(logsMutex_);
             logs_.emplace_back(time(nullptr), output_message);
+            break;
         }
-        else if (ins.opcode == 5 && ins.args.size() == 1) { // SLEEP
-            uint8_t ticks = static_cast<uint8_t>(getValue(ins.args[0]));
+        case 5: { // SLEEP
+            uint8_t ticks = static_cast<uint8_t>(getValue(ins.kind[0], ins.value[0]));
             isSleeping_ = true;
-            sleepTargetTick_ = globalCpuTicks.load() + ticks;
+            sleepTargetTick_ = cpuClock.now() + ticks;
+            break;
         }
-        else if (ins.opcode == 6 && ins.args.size() == 1) {
-            uint16_t repeatCount = getValue(ins.args[0]);
+        case 6: { // FOR
+            uint16_t repeatCount = getValue(ins.kind[0], ins.value[0]);
             if (repeatCount > 1000) repeatCount = 1000;
             if (loopStack.size() >= 3) return false; // Fail if nesting too deep
 
-            loopStack.push_back({ insCount_, repeatCount });
+            // The body starts after the FOR; END jumps back there rather than re-running the FOR
+            loopStack.push_back({ insCount_ + 1, repeatCount });
+            break;
         }
-        else if (ins.opcode == 7) { // END
+        case 7: { // END
             if (!loopStack.empty()) {
                 LoopState& currentLoop = loopStack.back();
                 currentLoop.repeats--;
                 if (currentLoop.repeats > 0) {
                     insCount_ = currentLoop.startIns;
+                    jumped_ = true;
                 }
                 else {
                     loopStack.pop_back();
@@ -150,38 +146,28 @@ bool Process::execute(const Instruction& ins, int coreId) {
                 std::lock_guard<std::mutex> lock(logsMutex_);
                 logs_.emplace_back(time(nullptr), "[Error] END without matching FOR!");
             }
+            break;
         }
-        else if (ins.opcode == 8 && ins.args.size() == 2) { // READ
-            const std::string& varName = ins.args[0];
-            const std::string& sourceAddress = ins.args[1];
-
-            if (!symbolTable_.count(varName)) {
-                if (symbolTable_.size() * 2 < allocatedMemoryBytes_) {
-                    std::string logicalAddress = memoryManager_->allocateVariable(shared_from_this(), varName);
-                    if (logicalAddress.empty()) {
-                        std::lock_guard<std::mutex> lock(logsMutex_);
-                        logs_.emplace_back(time(nullptr), "[Warning] Cannot declare '" + varName + "'. Memory allocation failed.");
-                        return true; // Still return true if the instruction didn't crash
-                    }
-                }
-                else {
-                    std::lock_guard<std::mutex> lock(logsMutex_);
-                    logs_.emplace_back(time(nullptr), "[Warning] Process memory full. READ for '" + varName + "' ignored.");
-                    return true;
-                }
+        case 8: { // READ
+            int slot = ins.value[0];
+            if (slotAddress_[slot] < 0 && !declare(slot, "READ")) {
+                return true; // Still return true if the instruction didn't crash
             }
             if (memoryManager_) {
-                uint16_t value = memoryManager_->read(sourceAddress, shared_from_this());
-                const std::string& destAddress = symbolTable_.at(varName);
-                memoryManager_->write(destAddress, value, shared_from_this());
+                uint16_t value = readAddress(ins.kind[1], ins.value[1]);
+                memoryManager_->write(slotAddress_[slot], value, self);
             }
+            break;
         }
-        else if (ins.opcode == 9 && ins.args.size() == 2) { // WRITE
-            const std::string& destAddress = ins.args[0];
-            uint16_t value = getValue(ins.args[1]);
+        case 9: { // WRITE
+            uint16_t value = getValue(ins.kind[1], ins.value[1]);
             if (memoryManager_) {
-                memoryManager_->write(destAddress, value, shared_from_this());
+                writeAddress(ins.kind[0], ins.value[0], value);
             }
+            break;
+        }
+        default: // Malformed source instructions compile to opcode 0 and do nothing
+            break;
         }
 
         // Return true on successful execution
@@ -211,7 +197,7 @@ void Process::setTerminationReason(TerminationReason reason, const std::string&
 
 // Loads instructions from a single string and parses them into the instruction list
 void Process::loadInstructionsFromString(const std::string& instruction_str) {
-    insList.clear();
+    std::vector<Instruction> source;
     std::stringstream ss(instruction_str);
     std::string segment;
     std::unordered_map<std::string, uint8_t> opcodeMap = {
@@ -266,18 +252,146 @@ void Process::loadInstructionsFromString(const std::string& instruction_str) {
                     inst.args.push_back(arg);
                 }
             }
-            insList.push_back(inst);
+            source.push_back(inst);
         }
         else {
         }
     }
+    compile(source);
+}
+
+int Process::internVariable(const std::string& name, std::unordered_map<std::string, int>& slots) {
+    auto it = slots.find(name);
+    if (it != slots.end()) return it->second;
+
+    int slot = static_cast<int>(slotNames_.size());
+    slots.emplace(name, slot);
+    slotNames_.push_back(name);
+    return slot;
+}
+
+// Lowers source instructions into fixed-size records: immediates are decoded, variable
+// names become slot indices and memory operands become integer logical addresses.
+// Only names that DECLARE or READ can bind get a slot; any other name always reads as 0.
+// Instructions with the wrong number of operands compile to a no-op (opcode 0).
+void Process::compile(const std::vector<Instruction>& source) {
+    program_.clear();
+    printFormats_.clear();
+    stringPool_.clear();
+    slotNames_.clear();
+    std::unordered_map<std::string, int> slots;
+    for (const Instruction& ins : source) {
+        if ((ins.opcode == 1 || ins.opcode == 8) && !ins.args.empty()) {
+            internVariable(ins.args[0], slots);
+        }
+    }
+    auto findSlot = [&slots](const std::string& name) {
+        auto it = slots.find(name);
+        return it != slots.end() ? it->second : -1;
+        };
+
+    auto valueOperand = [&](const std::string& token, OperandKind& kind, int32_t& value) {
+        if (!token.empty() && (isdigit(token[0]) || (token[0] == '-' && token.size() > 1))) {
+            kind = OperandKind::IMMEDIATE;
+            try { value = std::stoi(token); }
+            catch (const std::exception&) { value = 0; }
+        }
+        else {
+            value = findSlot(token);
+            kind = value >= 0 ? OperandKind::VARIABLE : OperandKind::IMMEDIATE;
+            if (value < 0) value = 0;
+        }
+        };
+
+    auto addressOperand = [&](const std::string& token, OperandKind& kind, int32_t& value) {
+        value = MemoryManager::parseAddress(token);
+        kind = OperandKind::ADDRESS;
+        if (value < 0) {
+            kind = OperandKind::BAD_ADDRESS;
+            value = static_cast<int32_t>(stringPool_.size());
+            stringPool_.push_back(token);
+        }
+        };
+
+    auto stripAndTrim = [](std::string s) {
+        size_t first = s.find_first_not_of(" \t\n\r");
+        if (std::string::npos == first) s.clear();
+        else s = s.substr(first, (s.find_last_not_of(" \t\n\r") - first + 1));
+        if (s.length() >= 2 && s.front() == '"' && s.back() == '"') {
+            return s.substr(1, s.length() - 2);
+        }
+        return s;
+        };
+
+    program_.reserve(source.size());
+    for (const Instruction& ins : source) {
+        CompiledInstruction out;
+        out.opcode = ins.opcode;
+        const auto& args = ins.args;
+
+        switch (ins.opcode) {
+        case 1: // DECLARE var [value]
+            if (args.empty()) { out.opcode = 0; break; }
+            out.kind[0] = OperandKind::VARIABLE;
+            out.value[0] = internVariable(args[0], slots);
+            if (args.size() == 2) valueOperand(args[1], out.kind[1], out.value[1]);
+            break;
+        case 2: // ADD dest a b
+        case 3: // SUB dest a b
+            if (args.size() != 3 || findSlot(args[0]) < 0) { out.opcode = 0; break; }
+            out.kind[0] = OperandKind::VARIABLE;
+            out.value[0] = findSlot(args[0]);
+            valueOperand(args[1], out.kind[1], out.value[1]);
+            valueOperand(args[2], out.kind[2], out.value[2]);
+            break;
+        case 4: { // PRINT
+            if (args.empty()) break;
+            std::vector<PrintPart> parts;
+            std::stringstream arg_splitter(args[0]);
+            std::string part;
+            while (std::getline(arg_splitter, part, '+')) {
+                std::string processed_part = stripAndTrim(part);
+                if (!processed_part.empty()) {
+                    parts.push_back({ processed_part, findSlot(processed_part) });
+                }
+            }
+            out.kind[0] = OperandKind::PRINT_FORMAT;
+            out.value[0] = static_cast<int32_t>(printFormats_.size());
+            printFormats_.push_back(std::move(parts));
+            break;
+        }
+        case 5: // SLEEP ticks
+        case 6: // FOR repeats
+            if (args.size() != 1) { out.opcode = 0; break; }
+            valueOperand(args[0], out.kind[0], out.value[0]);
+            break;
+        case 7: // END
+            break;
+        case 8: // READ var addr
+            if (args.size() != 2) { out.opcode = 0; break; }
+            out.kind[0] = OperandKind::VARIABLE;
+            out.value[0] = internVariable(args[0], slots);
+            addressOperand(args[1], out.kind[1], out.value[1]);
+            break;
+        case 9: // WRITE addr value
+            if (args.size() != 2) { out.opcode = 0; break; }
+            addressOperand(args[0], out.kind[0], out.value[0]);
+            valueOperand(args[1], out.kind[1], out.value[1]);
+            break;
+        default:
+            out.opcode = 0;
+            break;
+        }
+        program_.push_back(out);
+    }
+
+    slotAddress_.assign(slotNames_.size(), -1);
+    declaredCount_.store(0, std::memory_order_relaxed);
 }
 
 void Process::genRandInst(uint64_t min_ins, uint64_t max_ins, int memorySize) {
-    insList.clear();
+    std::vector<Instruction> insList;
     logs_.clear();
-    symbolTable_.clear();
-    symbolTableOffset_ = 0;
     loopStack.clear();
     insCount_ = 0;
 
@@ -330,7 +444,7 @@ void Process::genRandInst(uint64_t min_ins, uint64_t max_ins, int memorySize) {
         switch (opcode) {
         case 1: // DECLARE
             // Ensure we don't try to declare more variables than memory can hold
-            if (varPool.empty() || symbolTable_.size() * 2 >= memorySize) {
+            if (varPool.empty() || getDeclaredVariableCount() * 2 >= memorySize) {
                 continue;
             }
             ins.args.push_back(varPool[distVar(gen)]);
@@ -417,6 +531,7 @@ void Process::genRandInst(uint64_t min_ins, uint64_t max_ins, int memorySize) {
     if (insList.size() > totalInstructions) {
         insList.resize(totalInstructions);
     }
+    compile(insList);
 }
 
 // Executes one instruction step for the process, returns false if finished or sleeping
@@ -426,7 +541,7 @@ bool Process::runOneInstruction(int coreId) {
     }
 
     if (isSleeping_) {
-        if (globalCpuTicks.load() >= sleepTargetTick_) {
+        if (cpuClock.now() >= sleepTargetTick_) {
             isSleeping_ = false;
         }
         else {
@@ -434,13 +549,13 @@ bool Process::runOneInstruction(int coreId) {
         }
     }
 
-    if (insCount_ >= insList.size()) {
+    if (insCount_ >= program_.size()) {
         setTerminationReason(TerminationReason::FINISHED_NORMALLY);
         return false;
     }
 
-    const Instruction& currentIns = insList[insCount_];
-    uint64_t instructionIndexBeforeExecution = insCount_;
+    const CompiledInstruction& currentIns = program_[insCount_];
+    jumped_ = false;
 
     // If it returns false, the instruction stalled on a page fault.
     bool success = execute(currentIns, coreId);
@@ -448,7 +563,9 @@ bool Process::runOneInstruction(int coreId) {
         return false; // Signal to the Core that the process is stalled.
     }
 
-    if (insCount_ == instructionIndexBeforeExecution) {
+    // An END that loops back lands on the body's first instruction, which for an empty
+    // body is the END itself, so the jump can't be told from the index alone
+    if (!jumped_) {
         insCount_++;
     }
 
@@ -501,16 +618,17 @@ std::string Process::smi() const {
     }
 
     ss << "Current instruction line: " << insCount_ << "\n";
-    ss << "Lines of code: " << insList.size() << "\n";
+    ss << "Lines of code: " << program_.size() << "\n";
 
     ss << "Variables:\n";
-    if (symbolTable_.empty()) {
+    std::vector<std::pair<std::string, int>> variables = getVariables();
+    if (variables.empty()) {
         ss << "  (No variables declared)\n";
     }
     else {
-        for (const auto& pair : symbolTable_) {
-            const std::string& varName = pair.first;
-            const std::string& address = pair.second;
+        for (const auto& var : variables) {
+            const std::string& varName = var.first;
+            int address = var.second;
             uint16_t value = 0;
             if (memoryManager_ && terminationReason_ != TerminationReason::MEMORY_VIOLATION) {
                 try {
@@ -521,7 +639,7 @@ std::string Process::smi() const {
                     std::cerr << "Error getting variable value in smi(): " << e.what() << std::endl;
                 }
             }
-            ss << "  " << varName << " = " << value << " @ " << address << "\n";
+            ss << "  " << varName << " = " << value << " @ " << MemoryManager::formatAddress(address) << "\n";
         }
     }
 
@@ -531,13 +649,32 @@ std::string Process::smi() const {
 // Calculates the number of pages used by the symbol table based on frame size
 int Process::getSymbolTablePages(int frameSize) const {
     if (frameSize <= 0) return 0;
-    return static_cast<int>((symbolTableOffset_ + frameSize - 1) / frameSize);
+    return static_cast<int>((getDeclaredVariableCount() * 2 + frameSize - 1) / frameSize);
+}
+
+void Process::initPageTable(int pages) {
+    pageTable_.reset(new std::atomic<uint32_t>[pages]);
+    for (int i = 0; i < pages; ++i) {
+        pageTable_[i].store(0, std::memory_order_relaxed);
+    }
+    pageCount_ = pages;
+}
+
+void Process::bindVariable(int slot, int address) {
+    int index = declaredCount_.load(std::memory_order_relaxed);
+    slotAddress_[slot] = address;
+    declaredSlots_[index] = slot;
+    declaredCount_.store(index + 1, std::memory_order_release);
 }
 
-// For debugging
-Instruction Process::getCurrentInstruction() const {
-    if (insCount_ < insList.size()) {
-        return insList[insCount_];
+// Returns (name, logical address) for each declared variable, in declaration order
+std::vector<std::pair<std::string, int>> Process::getVariables() const {
+    std::vector<std::pair<std::string, int>> out;
+    int count = getDeclaredVariableCount();
+    out.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int slot = declaredSlots_[i];
+        out.emplace_back(slotNames_[slot], i * 2);
     }
-    return {}; // Return empty instruction if out of bounds
+    return out;
 }
\ No newline at end of file
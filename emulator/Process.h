@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include <string>
 #include <vector>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory> 
 #include <unordered_map>
@@ -10,11 +12,48 @@
 
 class MemoryManager;
 
+// Source form produced by the parser and the random generator
 struct Instruction {
     uint8_t opcode = 0;
     std::vector<std::string> args;
 };
 
+enum class OperandKind : uint8_t {
+    NONE,
+    IMMEDIATE,    // value holds the literal
+    VARIABLE,     // value holds a variable slot index
+    ADDRESS,      // value holds a decoded logical address
+    BAD_ADDRESS,  // value indexes the string pool (original text, for the violation report)
+    PRINT_FORMAT  // value indexes printFormats_
+};
+
+// Fixed-size record the interpreter runs; operands are resolved once at load time
+struct CompiledInstruction {
+    uint8_t opcode = 0;
+    OperandKind kind[3] = { OperandKind::NONE, OperandKind::NONE, OperandKind::NONE };
+    int32_t value[3] = { 0, 0, 0 };
+};
+
+// One '+'-separated piece of a PRINT argument: printed as the variable's value
+// if `slot` has been declared by the time it runs, otherwise as literal text
+struct PrintPart {
+    std::string text;
+    int slot;
+};
+
+// Page table entry packed into 32 bits: frame number in the low bits, status flags above it.
+// A page that is neither VALID nor SWAPPED has never been written out and reads as zeros.
+struct PageTableEntry {
+    static constexpr uint32_t FRAME_MASK = 0x0FFFFFFFu;
+    static constexpr uint32_t VALID = 1u << 28;
+    static constexpr uint32_t DIRTY = 1u << 29;
+    static constexpr uint32_t REFERENCED = 1u << 30;
+    static constexpr uint32_t SWAPPED = 1u << 31; // The page has a copy in swap
+
+    static uint32_t make(int frame) { return (static_cast<uint32_t>(frame) & FRAME_MASK) | VALID; }
+    static int frame(uint32_t pte) { return static_cast<int>(pte & FRAME_MASK); }
+};
+
 struct LoopState {
     uint64_t startIns;
     uint16_t repeats;
@@ -22,6 +61,8 @@ struct LoopState {
 
 class Process : public std::enable_shared_from_this<Process> {
 public:
+    static constexpr int MAX_VARIABLES = 32; // 64-byte symbol table segment, 2 bytes per variable
+
     enum class TerminationReason {
         RUNNING,
         FINISHED_NORMALLY,
@@ -31,9 +72,11 @@ public:
     Process(uint64_t pid, std::string name, MemoryManager* memManager);
 
     // Public Methods
-    bool execute(const Instruction& ins, int coreId);
+    bool execute(const CompiledInstruction& ins, int coreId);
     bool runOneInstruction(int coreId);
     void genRandInst(uint64_t min_ins, uint64_t max_ins, int memorySize);
+    // Restarts the generator behind genRandInst, for reproducible workloads
+    static void seedRandom(uint32_t seed);
     void loadInstructionsFromString(const std::string& instruction_str);
     std::string smi() const;
 
@@ -43,21 +86,32 @@ public:
     bool isFinished() const { return finished_.load(); }
     bool isSleeping() const { return isSleeping_.load(); }
     uint64_t getSleepTargetTick() const { return sleepTargetTick_; }
-    size_t getTotalInstructions() const { return insList.size(); }
+    size_t getTotalInstructions() const { return program_.size(); }
     uint64_t getCurrentInstructionIndex() const { return insCount_; }
     time_t getFinishTime() const { return finishTime_; }
     int getAllocatedMemory() const { return allocatedMemoryBytes_; }
     bool hasBeenScheduled() const { return hasBeenScheduled_; }
+    int getLastCoreId() const { return lastCoreId_; }
     TerminationReason getTerminationReason() const { return terminationReason_; }
     time_t getViolationTime() const { return violationTime_; }
     const std::string& getViolationAddress() const { return violationAddress_; }
-    std::unordered_map<int, int>& getPageTable() { return pageTable_; }
-    const std::unordered_map<int, int>& getPageTable() const { return pageTable_; }
-    std::unordered_map<int, bool>& getValidBits() { return validBits_; }
-    const std::unordered_map<int, bool>& getValidBits() const { return validBits_; }
-    std::unordered_map<std::string, std::string>& getSymbolTable() { return symbolTable_; }
+
+    // Page table: one atomic entry per page, sized once by MemoryManager::allocateMemory
+    // and then read and updated without locking
+    void initPageTable(int pages);
+    int getPageCount() const { return pageCount_; }
+    uint32_t loadPte(int page) const { return pageTable_[page].load(std::memory_order_acquire); }
+    void storePte(int page, uint32_t pte) { pageTable_[page].store(pte, std::memory_order_release); }
+    void setPteFlags(int page, uint32_t flags) { pageTable_[page].fetch_or(flags, std::memory_order_relaxed); }
+    uint32_t clearPteFlags(int page, uint32_t flags) { return pageTable_[page].fetch_and(~flags, std::memory_order_acq_rel); }
     int getSymbolTablePages(int frameSize) const;
-    std::mutex& getPageTableMutex() { return pageTableMutex_; }
+
+    // Symbol table: variable slots in declaration order; the i-th declared variable
+    // lives at logical address i * 2. Readable from other threads without locking.
+    int getDeclaredVariableCount() const { return declaredCount_.load(std::memory_order_acquire); }
+    int getVariableAddress(int slot) const { return slotAddress_[slot]; }
+    void bindVariable(int slot, int address);
+    std::vector<std::pair<std::string, int>> getVariables() const;
 
 
     // Setters
@@ -68,11 +122,11 @@ public:
     void setHasBeenScheduled(bool scheduled) { hasBeenScheduled_ = scheduled; }
     void setTerminationReason(TerminationReason reason, const std::string& addr = "");
 
-    // For debugging
-    Instruction getCurrentInstruction() const;
-
 
 private:
+    void compile(const std::vector<Instruction>& source);
+    int internVariable(const std::string& name, std::unordered_map<std::string, int>& slots);
+
     uint64_t pid_;
     std::string name_;
     std::atomic<bool> finished_;
@@ -82,8 +136,11 @@ private:
     int lastCoreId_{ -1 };
 
     // Instructions
-    std::vector<Instruction> insList;
+    std::vector<CompiledInstruction> program_;
+    std::vector<std::vector<PrintPart>> printFormats_;
+    std::vector<std::string> stringPool_;
     uint64_t insCount_{ 0 };
+    bool jumped_{ false }; // The last instruction set insCount_ itself
     std::vector<LoopState> loopStack;
 
     // Logs
@@ -93,11 +150,12 @@ private:
     // Memory
     MemoryManager* memoryManager_;
     int allocatedMemoryBytes_;
-    std::unordered_map<std::string, std::string> symbolTable_;
-    int symbolTableOffset_{ 0 };
-    std::unordered_map<int, int> pageTable_;
-    std::unordered_map<int, bool> validBits_;
-    mutable std::mutex pageTableMutex_;
+    std::vector<std::string> slotNames_;   // variable slot -> name, fixed at compile time
+    std::vector<int> slotAddress_;         // variable slot -> logical address, -1 until declared
+    std::array<int, MAX_VARIABLES> declaredSlots_{};
+    std::atomic<int> declaredCount_{ 0 };
+    std::unique_ptr<std::atomic<uint32_t>[]> pageTable_;
+    int pageCount_{ 0 };
     bool hasBeenScheduled_;
 
     // Termination info
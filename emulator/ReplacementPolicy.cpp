@@ -0,0 +1,203 @@
+#include "ReplacementPolicy.h"
+#include "Process.h"
+#include <vector>
+
+namespace {
+
+    // Evicts in load order. Frames are kept on an intrusive doubly-linked list so removal is O(1).
+    class FifoPolicy : public ReplacementPolicy {
+    public:
+        explicit FifoPolicy(int totalFrames)
+            : prev_(totalFrames, -1), next_(totalFrames, -1), present_(totalFrames, false) {
+        }
+
+        const char* name() const override { return "fifo"; }
+
+        void onLoad(int frame, uint64_t) override {
+            if (present_[frame]) onRemove(frame);
+            present_[frame] = true;
+            prev_[frame] = tail_;
+            next_[frame] = -1;
+            if (tail_ != -1) next_[tail_] = frame;
+            else head_ = frame;
+            tail_ = frame;
+        }
+
+        void onRemove(int frame) override {
+            if (!present_[frame]) return;
+            present_[frame] = false;
+            if (prev_[frame] != -1) next_[prev_[frame]] = next_[frame];
+            else head_ = next_[frame];
+            if (next_[frame] != -1) prev_[next_[frame]] = prev_[frame];
+            else tail_ = prev_[frame];
+        }
+
+        int selectVictim(FrameAccess&, uint64_t) override {
+            return head_;
+        }
+
+    private:
+        std::vector<int> prev_;
+        std::vector<int> next_;
+        std::vector<bool> present_;
+        int head_ = -1; // oldest
+        int tail_ = -1;
+    };
+
+    // Second chance: the hand sweeps the frames, clearing referenced bits, and evicts
+    // the first page that has not been referenced since the hand last passed it.
+    class ClockPolicy : public ReplacementPolicy {
+    public:
+        explicit ClockPolicy(int totalFrames) : present_(totalFrames, false) {}
+
+        const char* name() const override { return "clock"; }
+
+        void onLoad(int frame, uint64_t) override {
+            if (!present_[frame]) ++resident_;
+            present_[frame] = true;
+        }
+
+        void onRemove(int frame) override {
+            if (present_[frame]) --resident_;
+            present_[frame] = false;
+        }
+
+        int selectVictim(FrameAccess& frames, uint64_t) override {
+            if (resident_ == 0) return -1;
+            int n = static_cast<int>(present_.size());
+            // Running processes can set referenced bits again behind the hand, so give up
+            // on second chances after two full sweeps
+            for (int step = 0; step < 2 * n; ++step) {
+                int frame = advance();
+                if (!present_[frame]) continue;
+                if (frames.pageFlags(frame) & PageTableEntry::REFERENCED) {
+                    frames.clearReferenced(frame);
+                    continue;
+                }
+                return frame;
+            }
+            while (!present_[hand_]) advance();
+            return advance();
+        }
+
+    private:
+        int advance() {
+            int frame = hand_;
+            hand_ = (hand_ + 1) % static_cast<int>(present_.size());
+            return frame;
+        }
+
+        std::vector<bool> present_;
+        int resident_ = 0;
+        int hand_ = 0;
+    };
+
+    // LRU approximation by aging: at every replacement decision each resident page's
+    // 8-bit age is shifted right and its referenced bit shifted in at the top; the page
+    // with the smallest age has gone longest without being used.
+    class AgingPolicy : public ReplacementPolicy {
+    public:
+        explicit AgingPolicy(int totalFrames) : age_(totalFrames, 0), present_(totalFrames, false) {}
+
+        const char* name() const override { return "lru"; }
+
+        void onLoad(int frame, uint64_t) override {
+            present_[frame] = true;
+            age_[frame] = 0x80; // Counts as just referenced, so it is not the next victim
+        }
+
+        void onRemove(int frame) override {
+            present_[frame] = false;
+        }
+
+        int selectVictim(FrameAccess& frames, uint64_t) override {
+            int n = static_cast<int>(age_.size());
+            if (n == 0) return -1;
+            int victim = -1;
+            // Start one frame further along each time so ties do not always hit the same frames
+            for (int i = 0; i < n; ++i) {
+                int frame = (start_ + i) % n;
+                if (!present_[frame]) continue;
+                bool referenced = (frames.pageFlags(frame) & PageTableEntry::REFERENCED) != 0;
+                age_[frame] = static_cast<uint8_t>((age_[frame] >> 1) | (referenced ? 0x80 : 0));
+                if (referenced) frames.clearReferenced(frame);
+                if (victim == -1 || age_[frame] < age_[victim]) victim = frame;
+            }
+            start_ = (start_ + 1) % n;
+            return victim;
+        }
+
+    private:
+        std::vector<uint8_t> age_;
+        std::vector<bool> present_;
+        int start_ = 0;
+    };
+
+    // WSClock: a clock sweep that records when each page was last seen referenced and
+    // only evicts pages that have left the working set (unused for longer than the
+    // window). Clean pages are preferred, since evicting them needs no write-back.
+    class WsClockPolicy : public ReplacementPolicy {
+    public:
+        WsClockPolicy(int totalFrames, uint64_t window)
+            : lastUse_(totalFrames, 0), present_(totalFrames, false), window_(window) {
+        }
+
+        const char* name() const override { return "wsclock"; }
+
+        void onLoad(int frame, uint64_t now) override {
+            if (!present_[frame]) ++resident_;
+            present_[frame] = true;
+            lastUse_[frame] = now;
+        }
+
+        void onRemove(int frame) override {
+            if (present_[frame]) --resident_;
+            present_[frame] = false;
+        }
+
+        int selectVictim(FrameAccess& frames, uint64_t now) override {
+            if (resident_ == 0) return -1;
+            int n = static_cast<int>(present_.size());
+            int dirtyCandidate = -1;
+            int oldest = -1;
+            for (int step = 0; step < n; ++step) {
+                int frame = hand_;
+                hand_ = (hand_ + 1) % n;
+                if (!present_[frame]) continue;
+
+                uint32_t flags = frames.pageFlags(frame);
+                if (flags & PageTableEntry::REFERENCED) {
+                    frames.clearReferenced(frame);
+                    lastUse_[frame] = now;
+                }
+                else if (now - lastUse_[frame] > window_) {
+                    if (!(flags & PageTableEntry::DIRTY)) return frame;
+                    if (dirtyCandidate == -1) dirtyCandidate = frame;
+                }
+                if (oldest == -1 || lastUse_[frame] < lastUse_[oldest]) oldest = frame;
+            }
+            // Every page is either in the working set or dirty: take an old dirty page,
+            // otherwise the least recently used one
+            return dirtyCandidate != -1 ? dirtyCandidate : oldest;
+        }
+
+    private:
+        std::vector<uint64_t> lastUse_;
+        std::vector<bool> present_;
+        uint64_t window_;
+        int resident_ = 0;
+        int hand_ = 0;
+    };
+}
+
+std::unique_ptr<ReplacementPolicy> ReplacementPolicy::create(const std::string& name, int totalFrames, uint64_t workingSetWindow) {
+    if (name == "fifo") return std::make_unique<FifoPolicy>(totalFrames);
+    if (name == "clock") return std::make_unique<ClockPolicy>(totalFrames);
+    if (name == "lru") return std::make_unique<AgingPolicy>(totalFrames);
+    if (name == "wsclock") return std::make_unique<WsClockPolicy>(totalFrames, workingSetWindow);
+    return nullptr;
+}
+
+bool ReplacementPolicy::isValidName(const std::string& name) {
+    return name == "fifo" || name == "clock" || name == "lru" || name == "wsclock";
+}
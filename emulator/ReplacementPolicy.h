@@ -0,0 +1,41 @@
+// ReplacementPolicy.h
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What a replacement policy may ask about the page resident in a frame.
+// Flags are PageTableEntry::REFERENCED / PageTableEntry::DIRTY, set by MemoryManager::pinPage.
+class FrameAccess {
+public:
+    virtual uint32_t pageFlags(int frame) const = 0;
+    virtual void clearReferenced(int frame) = 0;
+
+protected:
+    ~FrameAccess() = default;
+};
+
+// Chooses which resident frame to evict when memory is full. MemoryManager calls every
+// hook with its frame lock held, so implementations need no synchronization of their own.
+// `now` is the global CPU tick.
+class ReplacementPolicy {
+public:
+    virtual ~ReplacementPolicy() = default;
+
+    virtual const char* name() const = 0;
+
+    // The frame now holds a freshly faulted-in page
+    virtual void onLoad(int frame, uint64_t now) = 0;
+    // The frame no longer holds a page (evicted, or its process was deallocated)
+    virtual void onRemove(int frame) = 0;
+    // Returns a resident frame to evict, or -1 if there is none. Does not remove it.
+    virtual int selectVictim(FrameAccess& frames, uint64_t now) = 0;
+
+    // How long (in CPU ticks) a page stays in a process's working set after its last use
+    static constexpr uint64_t DEFAULT_WORKING_SET_WINDOW = 50000;
+
+    // "fifo", "clock", "lru" (aging) or "wsclock"; returns nullptr for an unknown name
+    static std::unique_ptr<ReplacementPolicy> create(const std::string& name, int totalFrames,
+        uint64_t workingSetWindow = DEFAULT_WORKING_SET_WINDOW);
+    static bool isValidName(const std::string& name);
+};
@@ -23,7 +23,6 @@ Scheduler::Scheduler(int num_cpu, const std::string& scheduler_type, uint64_t qu
     cores_.reserve(numCpus_);
     for (int i = 0; i < numCpus_; ++i) {
         cores_.emplace_back(std::make_unique<Core>(i, this, delayPerExec_));
-        coreTicksUsed_.emplace_back(std::make_unique<std::atomic<uint64_t>>(0));
     }
 }
 
@@ -34,14 +33,18 @@ Scheduler::~Scheduler() {
 void Scheduler::start() {
     if (!running_.load()) {
         running_ = true;
-        schedulerStartTime_ = globalCpuTicks.load();
+        schedulerStartTime_ = cpuClock.now();
+        for (auto& core : cores_) {
+            core->start();
+        }
         schedulerThread_ = std::thread(&Scheduler::schedulerLoop, this);
     }
 }
 
 void Scheduler::stop() {
-    // 1. First, set the flag that stops the main scheduler loop.
+    // 1. First, set the flag that stops the main scheduler loop and wake it.
     running_ = false;
+    notifyDispatch();
 
     // 2. Stop process generation gracefully.
     processGenEnabled_ = false;
@@ -49,32 +52,86 @@ void Scheduler::stop() {
         processGenThread_.join();
     }
 
-    // 3. Stop all core worker threads by setting their flags.
-    for (const auto& core : cores_) {
-        core->stop();
-    }
-
-    // 4. Wait for the main scheduler thread to finish.
+    // 3. Wait for the main scheduler thread to finish so no sleeper is woken mid-shutdown.
     if (schedulerThread_.joinable()) {
         schedulerThread_.join();
     }
+
+    // 4. Shut down the persistent core worker threads.
+    for (const auto& core : cores_) {
+        core->stop();
+    }
 }
 
 void Scheduler::submit(std::shared_ptr<Process> p) {
-    readyQueue_.push(p);
+    readyQueue_.push(std::move(p));
     activeProcessesCount_++;
+    wakeIdleCore();
 }
 
 void Scheduler::requeueProcess(std::shared_ptr<Process> p) {
     if (p->isSleeping()) {
-        std::lock_guard<std::mutex> lock(sleepingProcessesMutex_);
-        sleepingProcesses_.push_back(p);
+        sleepingProcesses_.push(p);
+        notifyDispatch();
     }
     else {
-        readyQueue_.push(p);
+        enqueueReady(std::move(p));
     }
 }
 
+// A process that has run before goes back to the run queue of the core that last ran it,
+// unless processes are already waiting on the global queue: then it queues behind them, as
+// it would have with a single queue. Local queues therefore only fill while the global one
+// is empty, so whatever they hold is older than anything on the global queue.
+void Scheduler::enqueueReady(std::shared_ptr<Process> p) {
+    int owner = p->getLastCoreId();
+    if (owner < 0 || owner >= numCpus_ || !readyQueue_.empty()) {
+        readyQueue_.push(std::move(p));
+        wakeIdleCore();
+        return;
+    }
+
+    Core* core = cores_[owner].get();
+    bool hadWork = core->pushLocal(std::move(p));
+    if (core->isParked()) {
+        core->wake();
+    }
+    else if (!core->isWorkerThread() || hadWork) {
+        // The owner is busy with something else, or already has work lined up; let an idle
+        // core steal instead of waiting.
+        wakeIdleCore();
+    }
+}
+
+// Skips parked cores that already have a wakeup on the way, so two pushes in a row wake two cores
+void Scheduler::wakeIdleCore() {
+    for (auto& core : cores_) {
+        if (core->isParked() && core->wake()) return;
+    }
+}
+
+// The core's own run queue goes first, since it only holds processes that were queued
+// before anything now on the global queue (see enqueueReady); then the global queue, which
+// keeps requeues behind earlier arrivals; then stealing from the other cores.
+std::shared_ptr<Process> Scheduler::acquireNextProcess(int coreId) {
+    std::shared_ptr<Process> p;
+    if (cores_[coreId]->popLocal(p)) return p;
+    if (readyQueue_.try_pop(p)) return p;
+    for (int i = 1; i < numCpus_; ++i) {
+        if (cores_[(coreId + i) % numCpus_]->stealLocal(p)) return p;
+    }
+    return nullptr;
+}
+
+uint64_t Scheduler::getQuantum() const {
+    return (schedulerType_ == "rr") ? quantumCycles_ : UINT64_MAX;
+}
+
+void Scheduler::notifyDispatch() {
+    dispatchPending_ = true;
+    cpuClock.interruptWaiters();
+}
+
 void Scheduler::addFinishedProcess(std::shared_ptr<Process> p) {
     std::lock_guard<std::mutex> lock(finishedProcessesMutex_);
     if (finishedPIDs_.insert(p->getPid()).second) {
@@ -88,7 +145,7 @@ void Scheduler::addFinishedProcess(std::shared_ptr<Process> p) {
 void Scheduler::startProcessGeneration() {
     if (!processGenEnabled_.load()) {
         processGenEnabled_ = true;
-        lastProcessGenTick_ = globalCpuTicks.load();
+        lastProcessGenTick_ = cpuClock.now();
         processGenThread_ = std::thread(&Scheduler::processGeneratorLoop, this);
     }
 }
@@ -111,7 +168,8 @@ uint64_t Scheduler::getNextProcessId() {
 std::vector<std::shared_ptr<Process>> Scheduler::getRunningProcesses() const {
     std::vector<std::shared_ptr<Process>> running;
     for (const auto& core : cores_) {
-        if (core->isBusy()) running.push_back(core->getRunningProcess());
+        auto p = core->getRunningProcess();
+        if (p) running.push_back(p);
     }
     return running;
 }
@@ -126,8 +184,7 @@ std::vector<std::shared_ptr<Process>> Scheduler::getFinishedProcesses() const {
 }
 
 std::vector<std::shared_ptr<Process>> Scheduler::getSleepingProcesses() const {
-    std::lock_guard<std::mutex> lock(sleepingProcessesMutex_);
-    return sleepingProcesses_;
+    return sleepingProcesses_.snapshot();
 }
 
 double Scheduler::getCpuUtilization() const {
@@ -148,18 +205,33 @@ size_t Scheduler::getCoresAvailable() const {
 
 
 uint64_t Scheduler::getActiveCpuTicks() const {
-    uint64_t totalActiveTicks = 0;
-    for (const auto& coreTicks : coreTicksUsed_) {
-        totalActiveTicks += coreTicks->load();
-    }
-    return totalActiveTicks;
+    return getCoreStatsTotal().ticks;
 }
 
 
-void Scheduler::updateCoreUtilization(int coreId, uint64_t ticksUsed) {
-    if (coreId >= 0 && coreId < numCpus_) {
-        coreTicksUsed_[coreId]->fetch_add(ticksUsed);
+CoreStats::Snapshot Scheduler::getCoreStatsTotal() const {
+    CoreStats::Snapshot total;
+    for (const auto& core : cores_) {
+        total += core->getStats();
     }
+    return total;
+}
+
+double Scheduler::getAverageIdleGapMicros() const {
+    CoreStats::Snapshot total = getCoreStatsTotal();
+    return total.idleGapCount == 0 ? 0.0 : static_cast<double>(total.idleGapNanos) / total.idleGapCount / 1000.0;
+}
+
+uint64_t Scheduler::getTlbHits() const {
+    uint64_t hits = 0;
+    for (const auto& core : cores_) hits += core->getTlb().getHits();
+    return hits;
+}
+
+uint64_t Scheduler::getTlbMisses() const {
+    uint64_t misses = 0;
+    for (const auto& core : cores_) misses += core->getTlb().getMisses();
+    return misses;
 }
 
 Core* Scheduler::getCore(int index) const {
@@ -171,33 +243,9 @@ Core* Scheduler::getCore(int index) const {
 
 void Scheduler::schedulerLoop() {
     while (running_.load()) {
-        {
-            std::lock_guard<std::mutex> lock(sleepingProcessesMutex_);
-            auto now = globalCpuTicks.load();
-            auto it = sleepingProcesses_.begin();
-            while (it != sleepingProcesses_.end()) {
-                if ((*it)->isSleeping() && now >= (*it)->getSleepTargetTick()) {
-                    (*it)->setIsSleeping(false);
-                    readyQueue_.push(*it);
-                    it = sleepingProcesses_.erase(it);
-                }
-                else {
-                    ++it;
-                }
-            }
-        }
-
-        for (auto& core : cores_) {
-            if (!core->isBusy()) {
-                std::shared_ptr<Process> p;
-                if (readyQueue_.try_pop(p)) {
-
-                    // Assign the process directly to the core
-                    uint64_t quantum = (schedulerType_ == "rr") ? quantumCycles_ : UINT64_MAX;
-                    core->tryAssign(p, quantum);
-                }
-            }
-        }
+        // Dispatch itself happens on the cores, which pull from their run queues, the global
+        // queue and each other; this loop only services timers.
+        wakeDueSleepers(cpuClock.now());
 
         for (auto& core : cores_) {
             auto p = core->getRunningProcess();
@@ -208,38 +256,53 @@ void Scheduler::schedulerLoop() {
 
 
         // Log a memory snapshot periodically
-        uint64_t now = globalCpuTicks.load();
+        uint64_t now = cpuClock.now();
         if (quantumCycles_ > 0 && (now - lastQuantumSnapshot_) >= quantumCycles_) {
             memoryManager_.logMemorySnapshot();
             lastQuantumSnapshot_ = now;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Block until a new sleeper arrives, the clock reaches the next sleeper's wakeup
+        // tick, or the periodic snapshot interval passes
+        cpuClock.waitUntil(sleepingProcesses_.nextWakeTick(), std::chrono::microseconds(10000),
+            [this]() { return dispatchPending_.load() || !running_.load(); });
+        dispatchPending_ = false;
     }
 }
 
 void Scheduler::processGeneratorLoop() {
     while (processGenEnabled_.load()) {
-        uint64_t now = globalCpuTicks.load();
+        uint64_t now = cpuClock.now();
         if (now >= lastProcessGenTick_ + batchProcessFreq_) {
-            uint64_t pid = getNextProcessId();
-            std::string name = "p" + std::to_string(pid);
+            generateProcess();
+            lastProcessGenTick_ = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
 
-            // Get a valid memory size from the memory manager.
-            int memToAlloc = memoryManager_.getRandomMemorySize();
-            auto proc = std::make_shared<Process>(pid, name, &memoryManager_);
+std::shared_ptr<Process> Scheduler::generateProcess() {
+    uint64_t pid = getNextProcessId();
+    std::string name = "p" + std::to_string(pid);
 
-            proc->setAllocatedMemory(memToAlloc);
+    // Get a valid memory size from the memory manager.
+    int memToAlloc = memoryManager_.getRandomMemorySize();
+    auto proc = std::make_shared<Process>(pid, name, &memoryManager_);
 
-            // Generate random instructions *before* submitting the process.
-            proc->genRandInst(minInstructions_, maxInstructions_, memToAlloc);
+    proc->setAllocatedMemory(memToAlloc);
 
-            // Now, submit the fully-prepared process to the queue.
-            submit(proc);
+    // Generate random instructions *before* submitting the process.
+    proc->genRandInst(minInstructions_, maxInstructions_, memToAlloc);
 
-            lastProcessGenTick_ = now;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // Now, submit the fully-prepared process to the queue.
+    submit(proc);
+    return proc;
+}
+
+void Scheduler::wakeDueSleepers(uint64_t now) {
+    for (auto& p : sleepingProcesses_.popDue(now)) {
+        p->setIsSleeping(false);
+        enqueueReady(std::move(p));
     }
 }
 
@@ -252,12 +315,7 @@ std::shared_ptr<Process> Scheduler::findProcessById(uint64_t pid) const {
 
 
     // Search sleeping processes
-    {
-        std::lock_guard<std::mutex> sleep_lock(sleepingProcessesMutex_);
-        for (const auto& p : sleepingProcesses_) {
-            if (p->getPid() == pid) return p;
-        }
-    }
+    if (auto p = sleepingProcesses_.find(pid)) return p;
 
     // Search finished processes
     {
@@ -11,7 +11,8 @@
 
 #include "Core.h"
 #include "Process.h"
-#include "ThreadedQueue.h"
+#include "MPMCQueue.h"
+#include "SleepQueue.h"
 #include "GlobalState.h"
 #include "MemoryManager.h" 
 
@@ -27,6 +28,10 @@ public:
     void stop();
     void submit(std::shared_ptr<Process> p);
     void requeueProcess(std::shared_ptr<Process> p);
+    void notifyDispatch();
+
+    std::shared_ptr<Process> acquireNextProcess(int coreId);
+    uint64_t getQuantum() const;
     void startProcessGeneration();
     void stopProcessGeneration();
     void waitUntilAllDone();
@@ -46,16 +51,33 @@ public:
 
     uint64_t getActiveCpuTicks() const;
 
-    void updateCoreUtilization(int coreId, uint64_t ticksUsed);
+    // Every core's CoreStats added together
+    CoreStats::Snapshot getCoreStatsTotal() const;
+    // Mean time a core sat between quanta with nothing to run. Cores dispatch to themselves,
+    // so this is how long work was missing, not how long a dispatcher took to hand it over.
+    double getAverageIdleGapMicros() const;
+    uint64_t getTlbHits() const;
+    uint64_t getTlbMisses() const;
     Core* getCore(int index) const;
 
     MemoryManager& getMemoryManager() { return memoryManager_; }
     uint64_t getMinIns() const { return minInstructions_; }
     uint64_t getMaxIns() const { return maxInstructions_; }
+    int getCoreCount() const { return numCpus_; }
+    uint64_t getBatchProcessFreq() const { return batchProcessFreq_; }
+    uint64_t getDelayPerExec() const { return delayPerExec_; }
+
+    // One step each of the process generator and the sleeper timer, for callers that keep
+    // time themselves (Simulation) rather than running start()'s threads
+    std::shared_ptr<Process> generateProcess();
+    void wakeDueSleepers(uint64_t now);
+    uint64_t nextWakeTick() const { return sleepingProcesses_.nextWakeTick(); }
 
 private:
     void schedulerLoop();
     void processGeneratorLoop();
+    void enqueueReady(std::shared_ptr<Process> p);
+    void wakeIdleCore();
 
     int numCpus_;
     size_t nextCoreIndex_ = 0;
@@ -68,10 +90,9 @@ private:
     int frameSize_;
 
     std::vector<std::unique_ptr<Core>> cores_;
-    TSQueue<std::shared_ptr<Process>> readyQueue_;
+    MPMCQueue<std::shared_ptr<Process>> readyQueue_; // new arrivals, and requeues made while arrivals wait
 
-    mutable std::mutex sleepingProcessesMutex_;
-    std::vector<std::shared_ptr<Process>> sleepingProcesses_;
+    SleepQueue sleepingProcesses_;
 
     mutable std::mutex finishedProcessesMutex_;
     std::vector<std::shared_ptr<Process>> finishedProcesses_;
@@ -80,6 +101,10 @@ private:
     std::thread schedulerThread_;
     std::atomic<bool> running_ = false;
 
+    // Set when a process starts sleeping so the timer wait is recomputed; the scheduler
+    // thread waits on cpuClock, so setters interrupt its waiters.
+    std::atomic<bool> dispatchPending_ = false;
+
     std::thread processGenThread_;
     std::atomic<bool> processGenEnabled_ = false;
     std::atomic<uint64_t> lastProcessGenTick_ = 0;
@@ -87,7 +112,6 @@ private:
     std::atomic<uint64_t> nextPid_ = 1;
     std::atomic<int> activeProcessesCount_ = 0;
 
-    std::vector<std::unique_ptr<std::atomic<uint64_t>>> coreTicksUsed_;
     std::atomic<uint64_t> schedulerStartTime_ = 0;
 
     MemoryManager& memoryManager_;
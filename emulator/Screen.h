@@ -6,7 +6,7 @@
 #include <vector> // For logs
 #include <unordered_map> // For variables
 #include "Process.h"
-#include "GlobalState.h" // For globalCpuTicks in process-smi display
+#include "GlobalState.h" // For cpuClock in process-smi display
 
 
 class Screen {
@@ -38,7 +38,7 @@ private:
         system("clear");
 #endif
         std::cout << "--- Process Screen for " << process->getName() << " (PID: " << process->getPid() << ") --- (type 'exit' to leave)\n";
-        std::cout << "Current Global CPU Tick: " << globalCpuTicks.load() << "\n\n";
+        std::cout << "Current Global CPU Tick: " << cpuClock.now() << "\n\n";
     }
 
 
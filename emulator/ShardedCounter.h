@@ -0,0 +1,39 @@
+// ShardedCounter.h
+#pragma once
+#include "CacheLine.h"
+#include <atomic>
+#include <cstdint>
+
+// Statistics counter split into cache-line-padded shards. Each thread adds to its own shard,
+// so cores bumping the same counter do not fight over one cache line; reading sums the
+// shards. Totals are exact once writers are quiet and never run backwards while they are not.
+class ShardedCounter {
+public:
+    static constexpr int SHARDS = 16;
+
+    void add(uint64_t n = 1) {
+        shards_[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const {
+        uint64_t total = 0;
+        for (const Shard& s : shards_) total += s.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    // Padded by a full line so neighbouring shards never share one
+    struct Shard {
+        std::atomic<uint64_t> value{ 0 };
+        char pad[CACHE_LINE_BYTES];
+    };
+
+    // Threads are dealt shards round-robin the first time they touch any counter
+    static int shardIndex() {
+        static std::atomic<int> nextThread{ 0 };
+        thread_local int index = nextThread.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+
+    Shard shards_[SHARDS];
+};
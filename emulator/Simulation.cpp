@@ -0,0 +1,215 @@
+#include "Simulation.h"
+#include "Scheduler.h"
+#include "GlobalState.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    void advanceClockTo(uint64_t tick) {
+        uint64_t now = cpuClock.now();
+        if (tick > now) cpuClock.advance(tick - now);
+    }
+}
+
+Simulation::Simulation(Scheduler& scheduler)
+    : scheduler_(scheduler), instructionPeriod_(1 + scheduler.getDelayPerExec()),
+    cores_(scheduler.getCoreCount()) {
+    // A batch-process-freq of 0 would put every arrival on the same tick
+    schedule(cpuClock.now() + std::max<uint64_t>(scheduler_.getBatchProcessFreq(), 1), EventType::ARRIVAL);
+}
+
+Simulation::Result Simulation::run(uint64_t ticks) {
+    Result r;
+    r.startTick = cpuClock.now();
+    r.endTick = r.startTick + ticks;
+    r.cores = static_cast<int>(cores_.size());
+    runEnd_ = r.endTick;
+
+    CoreStats::Snapshot statsBefore = scheduler_.getCoreStatsTotal();
+    uint64_t pagedInBefore = scheduler_.getMemoryManager().getPagedInCount();
+    uint64_t pagedOutBefore = scheduler_.getMemoryManager().getPagedOutCount();
+    auto hostStart = std::chrono::steady_clock::now();
+
+    // Processes submitted from the console since the last run
+    dispatchIdleCores(r.startTick);
+    scheduleWakeup(r.startTick);
+
+    while (!events_.empty() && events_.top().tick < r.endTick) {
+        Event e = events_.top();
+        events_.pop();
+        advanceClockTo(e.tick);
+        ++r.events;
+
+        switch (e.type) {
+        case EventType::ARRIVAL: {
+            std::shared_ptr<Process> p = scheduler_.generateProcess();
+            arrivalTick_[p->getPid()] = e.tick;
+            ++r.processesArrived;
+            schedule(e.tick + std::max<uint64_t>(scheduler_.getBatchProcessFreq(), 1), EventType::ARRIVAL);
+            break;
+        }
+        case EventType::RETIRE:
+            cores_[e.core].eventQueued = false;
+            retire(e.core, e.tick, r);
+            break;
+        case EventType::QUANTUM_EXPIRY:
+            cores_[e.core].eventQueued = false;
+            endQuantum(e.core, e.tick, e.tick, Core::StepResult::RETIRED, r);
+            break;
+        case EventType::CORE_FREE:
+            cores_[e.core].eventQueued = false;
+            break;
+        case EventType::WAKEUP:
+            if (e.tick == queuedWakeup_) queuedWakeup_ = SleepQueue::NO_WAKEUP;
+            scheduler_.wakeDueSleepers(e.tick);
+            break;
+        }
+
+        // A retire that leaves its process on the core makes no work and puts no one to sleep
+        if (e.type == EventType::RETIRE && cores_[e.core].process) continue;
+        dispatchIdleCores(e.tick);
+        scheduleWakeup(e.tick);
+    }
+
+    advanceClockTo(r.endTick);
+    for (CoreState& c : cores_) {
+        if (!c.process) continue;
+        r.busyCoreTicks += r.endTick - c.busySince;
+        c.busySince = r.endTick;
+    }
+
+    r.hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+    CoreStats::Snapshot statsAfter = scheduler_.getCoreStatsTotal();
+    r.contextSwitches = statsAfter.contextSwitches - statsBefore.contextSwitches;
+    r.pageFaults = statsAfter.pageFaults - statsBefore.pageFaults;
+    r.pagedIn = scheduler_.getMemoryManager().getPagedInCount() - pagedInBefore;
+    r.pagedOut = scheduler_.getMemoryManager().getPagedOutCount() - pagedOutBefore;
+    return r;
+}
+
+void Simulation::schedule(uint64_t tick, EventType type, int core) {
+    events_.push(Event{ tick, nextSeq_++, type, core });
+    if (core >= 0) cores_[core].eventQueued = true;
+}
+
+void Simulation::retire(int core, uint64_t now, Result& r) {
+    CoreState& c = cores_[core];
+    Core* cpu = scheduler_.getCore(core);
+    cpu->bindToCurrentThread();
+
+    Core::StepResult result = cpu->step(c.process);
+    switch (result) {
+    case Core::StepResult::RETIRED:
+        ++c.executed;
+        ++r.instructionsRetired;
+        cpu->countTicks(1);
+        schedule(now + instructionPeriod_,
+            c.executed >= scheduler_.getQuantum() ? EventType::QUANTUM_EXPIRY : EventType::RETIRE, core);
+        break;
+    case Core::StepResult::SLEPT:
+        // The sleeper is requeued now so its wakeup counts from this tick
+        ++c.executed;
+        ++r.instructionsRetired;
+        cpu->countTicks(1);
+        endQuantum(core, now, now + instructionPeriod_, result, r);
+        break;
+    case Core::StepResult::BLOCKED:
+    case Core::StepResult::FAILED:
+        // Finishing frees the core at once; a stall costs a tick so the process can't be
+        // redispatched on the same tick forever
+        endQuantum(core, now, c.process->isFinished() ? now : now + 1, result, r);
+        break;
+    }
+}
+
+void Simulation::endQuantum(int core, uint64_t now, uint64_t freeAt, Core::StepResult last, Result& r) {
+    CoreState& c = cores_[core];
+    Core* cpu = scheduler_.getCore(core);
+    cpu->bindToCurrentThread();
+    cpu->endQuantum(c.process, c.executed, scheduler_.getQuantum(), last);
+
+    if (c.process->isFinished()) {
+        ++r.processesFinished;
+        auto it = arrivalTick_.find(c.process->getPid());
+        if (it != arrivalTick_.end()) {
+            r.turnaroundTicks += now - it->second;
+            ++r.turnaroundCount;
+            arrivalTick_.erase(it);
+        }
+    }
+
+    r.busyCoreTicks += std::min(freeAt, runEnd_) - c.busySince;
+    c.process.reset();
+    c.executed = 0;
+    if (freeAt > now) schedule(freeAt, EventType::CORE_FREE, core);
+}
+
+// Idle cores take work in core order, through the same queues and stealing as the
+// worker threads
+void Simulation::dispatchIdleCores(uint64_t now) {
+    for (int i = 0; i < static_cast<int>(cores_.size()); ++i) {
+        CoreState& c = cores_[i];
+        if (c.process || c.eventQueued) continue;
+
+        std::shared_ptr<Process> p = scheduler_.acquireNextProcess(i);
+        if (!p) continue;
+
+        Core* cpu = scheduler_.getCore(i);
+        cpu->bindToCurrentThread();
+        if (!cpu->beginQuantum(p)) {
+            // Its memory could not be allocated and it went back in the queue; retry next tick
+            schedule(now + 1, EventType::CORE_FREE, i);
+            continue;
+        }
+
+        c.process = std::move(p);
+        c.executed = 0;
+        c.busySince = now;
+        schedule(now, EventType::RETIRE, i);
+    }
+}
+
+void Simulation::scheduleWakeup(uint64_t now) {
+    uint64_t next = scheduler_.nextWakeTick();
+    if (next == SleepQueue::NO_WAKEUP || next >= queuedWakeup_) return;
+    queuedWakeup_ = std::max(next, now);
+    schedule(queuedWakeup_, EventType::WAKEUP);
+}
+
+void Simulation::printResult(const Result& r, std::ostream& out) {
+    uint64_t ticks = r.endTick - r.startTick;
+
+    auto fixed2 = [](double value) {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(2) << value;
+        return s.str();
+    };
+    std::string turnaround = r.turnaroundCount > 0
+        ? fixed2(static_cast<double>(r.turnaroundTicks) / r.turnaroundCount) : "N/A";
+    std::string utilization = ticks > 0 && r.cores > 0
+        ? fixed2(100.0 * r.busyCoreTicks / (static_cast<double>(ticks) * r.cores)) + "%" : "N/A";
+    std::string ticksPerSecond = r.hostSeconds > 0.0 ? fixed2(ticks / r.hostSeconds) : "N/A";
+
+    out << "\n+=======================================================================+\n";
+    out << "|                      DISCRETE-EVENT SIMULATION                        |\n";
+    out << "+=======================================================================+\n";
+    out << "| Metric                        | Value                                 |\n";
+    out << "+-------------------------------+---------------------------------------+\n";
+    out << "| Start Tick                    | " << std::right << std::setw(38) << r.startTick << "|\n";
+    out << "| End Tick                      | " << std::right << std::setw(38) << r.endTick << "|\n";
+    out << "| Events Processed              | " << std::right << std::setw(38) << r.events << "|\n";
+    out << "| Instructions Retired          | " << std::right << std::setw(38) << r.instructionsRetired << "|\n";
+    out << "| Processes Arrived             | " << std::right << std::setw(38) << r.processesArrived << "|\n";
+    out << "| Processes Finished            | " << std::right << std::setw(38) << r.processesFinished << "|\n";
+    out << "| Avg Turnaround (ticks)        | " << std::right << std::setw(38) << turnaround << "|\n";
+    out << "| Core Utilization              | " << std::right << std::setw(38) << utilization << "|\n";
+    out << "| Context Switches              | " << std::right << std::setw(38) << r.contextSwitches << "|\n";
+    out << "| Page Faults                   | " << std::right << std::setw(38) << r.pageFaults << "|\n";
+    out << "| Pages Paged In                | " << std::right << std::setw(38) << r.pagedIn << "|\n";
+    out << "| Pages Paged Out               | " << std::right << std::setw(38) << r.pagedOut << "|\n";
+    out << "| Host Time (s)                 | " << std::right << std::setw(38) << fixed2(r.hostSeconds) << "|\n";
+    out << "| Ticks per Host Second         | " << std::right << std::setw(38) << ticksPerSecond << "|\n";
+    out << "+=======================================================================+\n\n";
+}
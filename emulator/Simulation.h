@@ -0,0 +1,98 @@
+// Simulation.h
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "Core.h"
+#include "SleepQueue.h"
+
+class Scheduler;
+class Process;
+
+// Discrete-event run of the emulator. Instruction retires, quantum expiries, sleeper
+// wakeups and batch arrivals are events on one priority queue ordered by tick, and
+// cpuClock jumps straight from one to the next, so idle stretches cost nothing and a
+// busy core costs only the instructions it runs. The cores, processes and memory are
+// the scheduler's own, stepped from the calling thread in a fixed order, so with the
+// random generators seeded the same configuration replays exactly.
+// Neither Scheduler::start() nor the clock's wall-time thread may be running.
+class Simulation {
+public:
+    // What one run() covered; counters are for that run only
+    struct Result {
+        uint64_t startTick = 0;
+        uint64_t endTick = 0;
+        uint64_t events = 0;
+        uint64_t instructionsRetired = 0;
+        uint64_t processesArrived = 0;
+        uint64_t processesFinished = 0;
+        uint64_t turnaroundTicks = 0;  // Summed over finished batch processes
+        uint64_t turnaroundCount = 0;
+        uint64_t busyCoreTicks = 0;    // Ticks some core held a process, summed over cores
+        int cores = 0;
+        uint64_t contextSwitches = 0;
+        uint64_t pageFaults = 0;
+        uint64_t pagedIn = 0;
+        uint64_t pagedOut = 0;
+        double hostSeconds = 0.0;
+    };
+
+    explicit Simulation(Scheduler& scheduler);
+
+    // Simulates the next `ticks` ticks. Work still in flight at the end is left where it
+    // is, so two runs back to back are the same as one run over both.
+    Result run(uint64_t ticks);
+
+    static void printResult(const Result& r, std::ostream& out);
+
+private:
+    enum class EventType : uint8_t {
+        ARRIVAL,        // The next batch process is generated
+        RETIRE,         // `core` runs its process's next instruction
+        QUANTUM_EXPIRY, // `core`'s process has used its quantum
+        CORE_FREE,      // `core` can take a process again
+        WAKEUP          // Sleepers due by now go back to the ready queues
+    };
+
+    struct Event {
+        uint64_t tick;
+        uint64_t seq; // Breaks ties in the order events were scheduled
+        EventType type;
+        int core;
+    };
+
+    struct LaterEvent {
+        bool operator()(const Event& a, const Event& b) const {
+            return a.tick != b.tick ? a.tick > b.tick : a.seq > b.seq;
+        }
+    };
+
+    struct CoreState {
+        std::shared_ptr<Process> process; // Null while the core is idle
+        uint64_t executed = 0;            // Instructions this quantum
+        uint64_t busySince = 0;
+        bool eventQueued = false;         // A RETIRE, QUANTUM_EXPIRY or CORE_FREE is pending
+    };
+
+    void schedule(uint64_t tick, EventType type, int core = -1);
+    void retire(int core, uint64_t now, Result& r);
+    // Ends `core`'s quantum at `now`; the core takes new work again from `freeAt`
+    void endQuantum(int core, uint64_t now, uint64_t freeAt, Core::StepResult last, Result& r);
+    void dispatchIdleCores(uint64_t now);
+    void scheduleWakeup(uint64_t now);
+
+    Scheduler& scheduler_;
+    uint64_t instructionPeriod_; // Ticks per instruction: the instruction plus delay-per-exec
+
+    std::priority_queue<Event, std::vector<Event>, LaterEvent> events_;
+    uint64_t nextSeq_ = 0;
+    std::vector<CoreState> cores_;
+    uint64_t queuedWakeup_ = SleepQueue::NO_WAKEUP; // Earliest WAKEUP event pending
+    uint64_t runEnd_ = 0;
+
+    std::unordered_map<uint64_t, uint64_t> arrivalTick_; // Batch processes not yet finished
+};
@@ -0,0 +1,79 @@
+// SleepQueue.h
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "Process.h"
+
+// Min-heap of sleeping processes keyed on their wakeup tick.
+// Only the processes that are due are touched when the scheduler polls it.
+class SleepQueue {
+private:
+    struct Entry {
+        uint64_t wakeTick;
+        std::shared_ptr<Process> process;
+    };
+
+    struct LaterWake {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.wakeTick > b.wakeTick;
+        }
+    };
+
+    // Derives from priority_queue to reach the underlying container for snapshots
+    struct Heap : std::priority_queue<Entry, std::vector<Entry>, LaterWake> {
+        const std::vector<Entry>& entries() const { return c; }
+    };
+
+    Heap m_heap;
+    mutable std::mutex m_mutex;
+
+public:
+    static constexpr uint64_t NO_WAKEUP = UINT64_MAX;
+
+    void push(std::shared_ptr<Process> p) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t wakeTick = p->getSleepTargetTick();
+        m_heap.push({ wakeTick, std::move(p) });
+    }
+
+    // Removes and returns every process whose wakeup tick is at or before `now`.
+    std::vector<std::shared_ptr<Process>> popDue(uint64_t now) {
+        std::vector<std::shared_ptr<Process>> due;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!m_heap.empty() && m_heap.top().wakeTick <= now) {
+            due.push_back(m_heap.top().process);
+            m_heap.pop();
+        }
+        return due;
+    }
+
+    uint64_t nextWakeTick() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_heap.empty() ? NO_WAKEUP : m_heap.top().wakeTick;
+    }
+
+    std::shared_ptr<Process> find(uint64_t pid) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& e : m_heap.entries()) {
+            if (e.process->getPid() == pid) return e.process;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::shared_ptr<Process>> snapshot() const {
+        std::vector<std::shared_ptr<Process>> out;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        out.reserve(m_heap.entries().size());
+        for (const auto& e : m_heap.entries()) out.push_back(e.process);
+        return out;
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_heap.empty();
+    }
+};
@@ -0,0 +1,154 @@
+#include "SwapFile.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SwapFile::SwapFile(const std::string& path, int wordsPerPage, int initialSlots)
+    : path_(path), wordsPerPage_(wordsPerPage) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file != INVALID_HANDLE_VALUE) file_ = file;
+#else
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+#endif
+    map(initialSlots > 0 ? initialSlots : 1);
+}
+
+SwapFile::~SwapFile() {
+    unmap();
+#ifdef _WIN32
+    if (file_) CloseHandle(static_cast<HANDLE>(file_));
+#else
+    if (fd_ != -1) {
+        ::close(fd_);
+        std::remove(path_.c_str());
+    }
+#endif
+}
+
+// Grows the slot region to `slots`, keeping what the existing slots hold
+bool SwapFile::map(int slots) {
+    size_t bytes = static_cast<size_t>(slots) * wordsPerPage_ * sizeof(uint16_t);
+
+    if (!useHeap_) {
+        void* view = nullptr;
+#ifdef _WIN32
+        // A mapping larger than the file extends it; the old view stays valid until unmapped
+        HANDLE mapping = file_ ? CreateFileMappingA(static_cast<HANDLE>(file_), nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32), static_cast<DWORD>(bytes), nullptr) : nullptr;
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+            if (!view) CloseHandle(mapping);
+        }
+        if (view) {
+            unmap();
+            mapping_ = mapping;
+        }
+#else
+        if (fd_ != -1 && ftruncate(fd_, static_cast<off_t>(bytes)) == 0) {
+            view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (view == MAP_FAILED) view = nullptr;
+        }
+        if (view) unmap();
+#endif
+        if (view) {
+            base_ = static_cast<uint16_t*>(view);
+            capacity_ = slots;
+            return true;
+        }
+
+        std::cerr << "Warning: Could not map " << path_ << "; keeping swapped pages in memory." << std::endl;
+        if (base_) heap_.assign(base_, base_ + static_cast<size_t>(capacity_) * wordsPerPage_);
+        unmap();
+        useHeap_ = true;
+    }
+
+    heap_.resize(bytes / sizeof(uint16_t));
+    base_ = heap_.data();
+    capacity_ = slots;
+    return true;
+}
+
+void SwapFile::unmap() {
+    if (useHeap_ || !base_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(base_, static_cast<size_t>(capacity_) * wordsPerPage_ * sizeof(uint16_t));
+#endif
+    base_ = nullptr;
+}
+
+void SwapFile::addProcess(uint64_t pid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slotsByPid_[pid].clear();
+}
+
+void SwapFile::removeProcess(uint64_t pid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slotsByPid_.find(pid);
+    if (it == slotsByPid_.end()) return;
+    for (int slot : it->second) {
+        if (slot != -1) freeSlots_.push_back(slot);
+    }
+    slotsByPid_.erase(it);
+}
+
+bool SwapFile::isRegistered(uint64_t pid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slotsByPid_.count(pid) != 0;
+}
+
+int SwapFile::takeSlot_unlocked() {
+    if (!freeSlots_.empty()) {
+        int slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
+    }
+    if (nextUnused_ == capacity_) map(capacity_ * 2);
+    return nextUnused_++;
+}
+
+bool SwapFile::store(uint64_t pid, int page, const uint16_t* words) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slotsByPid_.find(pid);
+    if (it == slotsByPid_.end() || page < 0) return false;
+
+    std::vector<int>& slots = it->second;
+    if (page >= static_cast<int>(slots.size())) slots.resize(page + 1, -1);
+    int& slot = slots[page];
+    if (slot == -1) slot = takeSlot_unlocked();
+    std::memcpy(slotData(slot), words, static_cast<size_t>(wordsPerPage_) * sizeof(uint16_t));
+    return true;
+}
+
+bool SwapFile::load(uint64_t pid, int page, uint16_t* words) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slotsByPid_.find(pid);
+    if (it == slotsByPid_.end() || page < 0 || page >= static_cast<int>(it->second.size())) return false;
+
+    int slot = it->second[page];
+    if (slot == -1) return false;
+    std::memcpy(words, slotData(slot), static_cast<size_t>(wordsPerPage_) * sizeof(uint16_t));
+    return true;
+}
+
+int SwapFile::getSlotsInUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextUnused_ - static_cast<int>(freeSlots_.size());
+}
+
+int SwapFile::getSlotCapacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+}
@@ -0,0 +1,63 @@
+// SwapFile.h
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Swap space for paged-out pages: a file mapped into the address space and carved into
+// page-sized slots. Each registered process has a page -> slot index that grows as its
+// pages are stored; slots are handed out on a page's first store and go back on the
+// free list when the process is removed.
+// The mapping doubles in size when it runs out of slots. If the file cannot be mapped
+// the slots are kept in ordinary memory instead.
+class SwapFile {
+public:
+    static constexpr int INITIAL_SLOTS = 64;
+
+    SwapFile(const std::string& path, int wordsPerPage, int initialSlots = INITIAL_SLOTS);
+    ~SwapFile();
+
+    SwapFile(const SwapFile&) = delete;
+    SwapFile& operator=(const SwapFile&) = delete;
+
+    void addProcess(uint64_t pid);
+    // Frees every slot the process holds
+    void removeProcess(uint64_t pid);
+    bool isRegistered(uint64_t pid) const;
+
+    // Copies one page into the page's slot, taking a slot if it has none yet.
+    // Returns false if the process is not registered.
+    bool store(uint64_t pid, int page, const uint16_t* words);
+    // Copies the page's slot out; false if the page has never been stored
+    bool load(uint64_t pid, int page, uint16_t* words) const;
+
+    int getSlotsInUse() const;
+    int getSlotCapacity() const;
+
+private:
+    bool map(int slots);
+    void unmap();
+    int takeSlot_unlocked();
+    uint16_t* slotData(int slot) const { return base_ + static_cast<size_t>(slot) * wordsPerPage_; }
+
+    std::string path_;
+    int wordsPerPage_;
+    uint16_t* base_ = nullptr;
+    int capacity_ = 0;
+    int nextUnused_ = 0;      // Slots at and after this index have never been handed out
+    std::vector<int> freeSlots_;
+    std::unordered_map<uint64_t, std::vector<int>> slotsByPid_; // page -> slot, -1 when unstored
+
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    std::vector<uint16_t> heap_; // Backing for the slots when the file could not be mapped
+    bool useHeap_ = false;
+
+    mutable std::mutex mutex_;
+};
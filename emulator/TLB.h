@@ -0,0 +1,64 @@
+// TLB.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Small direct-mapped software TLB caching (pid, page) -> page table entry for one core.
+// Only the owning core's worker thread looks entries up or fills them; the hit/miss
+// counters may be read from any thread. Entries may go stale when a page is evicted; the
+// caller validates each translation it uses and invalidates the entries it finds stale.
+// The whole TLB is discarded when the epoch it was filled under is no longer current.
+class TLB {
+public:
+    static constexpr int SIZE = 16;
+
+    // Returns the cached page table entry, or 0 on a miss
+    uint32_t lookup(uint64_t pid, int page, uint64_t epoch) {
+        if (epoch != epoch_) {
+            flush();
+            epoch_ = epoch;
+        }
+        const Entry& e = entries_[index(pid, page)];
+        if (e.pte != 0 && e.pid == pid && e.page == page) {
+            hits_.store(hits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return e.pte;
+        }
+        misses_.store(misses_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    void insert(uint64_t pid, int page, uint32_t pte) {
+        Entry& e = entries_[index(pid, page)];
+        e.pid = pid;
+        e.page = page;
+        e.pte = pte;
+    }
+
+    void invalidate(uint64_t pid, int page) {
+        Entry& e = entries_[index(pid, page)];
+        if (e.pid == pid && e.page == page) e.pte = 0;
+    }
+
+    void flush() {
+        for (Entry& e : entries_) e.pte = 0;
+    }
+
+    uint64_t getHits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t getMisses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t pid = 0;
+        int page = -1;
+        uint32_t pte = 0;
+    };
+
+    static int index(uint64_t pid, int page) {
+        return static_cast<int>((static_cast<uint64_t>(page) ^ (pid * 7)) & (SIZE - 1));
+    }
+
+    Entry entries_[SIZE];
+    uint64_t epoch_ = 0;
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+};
@@ -0,0 +1,86 @@
+#include "VirtualClock.h"
+#include <algorithm>
+
+namespace {
+    // Longest the wall-clock thread sleeps between turning wall time into ticks; it wakes
+    // sooner when a waiter's deadline is due first
+    constexpr auto WALL_CLOCK_PERIOD = std::chrono::microseconds(1000);
+}
+
+VirtualClock::~VirtualClock() {
+    stop();
+}
+
+void VirtualClock::advance(uint64_t ticks) {
+    if (ticks == 0) return;
+    uint64_t reached = now_.fetch_add(ticks) + ticks;
+    // Pairs with the waiter publishing its deadline before checking now(): either the
+    // waiter sees the new time, or this sees its deadline and wakes it
+    if (reached >= nextDeadline_.load()) {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        waitCv_.notify_all();
+    }
+}
+
+void VirtualClock::start() {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    if (running_) return;
+    running_ = true;
+    wallClockThread_ = std::thread(&VirtualClock::wallClockLoop, this);
+}
+
+void VirtualClock::stop() {
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        running_ = false;
+    }
+    runCv_.notify_all();
+    if (wallClockThread_.joinable()) wallClockThread_.join();
+}
+
+void VirtualClock::interruptWaiters() {
+    std::lock_guard<std::mutex> lock(waitMutex_);
+    waitCv_.notify_all();
+}
+
+// Called with waitMutex_ held. Takes runMutex_ inside it, so the wall-clock thread must never
+// take waitMutex_ while holding runMutex_.
+void VirtualClock::publishNextDeadline_unlocked() {
+    uint64_t next = deadlines_.empty() ? NO_DEADLINE : *deadlines_.begin();
+    uint64_t previous = nextDeadline_.exchange(next);
+    if (next < previous) {
+        {
+            std::lock_guard<std::mutex> lock(runMutex_);
+            deadlineMoved_ = true;
+        }
+        runCv_.notify_all();
+    }
+}
+
+std::chrono::microseconds VirtualClock::nextWallClockWait() const {
+    uint64_t deadline = nextDeadline_.load();
+    uint64_t current = now();
+    if (deadline == NO_DEADLINE || deadline <= current) return WALL_CLOCK_PERIOD;
+
+    uint64_t micros = (deadline - current + TICKS_PER_MICROSECOND - 1) / TICKS_PER_MICROSECOND;
+    return std::min(WALL_CLOCK_PERIOD, std::chrono::microseconds(micros));
+}
+
+void VirtualClock::wallClockLoop() {
+    auto last = std::chrono::steady_clock::now();
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(runMutex_);
+            runCv_.wait_for(lock, nextWallClockWait(), [this]() { return !running_ || deadlineMoved_; });
+            if (!running_) return;
+            deadlineMoved_ = false;
+        }
+
+        // advance() may take waitMutex_, so runMutex_ is released first
+        auto current = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(current - last);
+        // Carry the sub-microsecond remainder over to the next period
+        last += elapsed;
+        advance(static_cast<uint64_t>(elapsed.count()) * TICKS_PER_MICROSECOND);
+    }
+}
@@ -0,0 +1,74 @@
+// VirtualClock.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+
+// The emulator's CPU tick clock. Time moves for two reasons: cores executing instructions
+// (one tick each), and wall time passing (one tick per microsecond), so sleepers still wake
+// and batches still arrive when every core is idle. Cores count their ticks locally and
+// publish them in batches; everyone reads the last published time. Waiting for a tick
+// blocks on a condition variable, which publishers only signal once the earliest waiter's
+// deadline has been reached. While every core is idle, the wall-clock thread sleeps until
+// that deadline is due rather than for a fixed period, so short waits are not rounded up to
+// the period; they are as precise as the OS timer.
+class VirtualClock {
+public:
+    static constexpr uint64_t TICKS_PER_MICROSECOND = 1;
+    static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+    VirtualClock() = default;
+    ~VirtualClock();
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    uint64_t now() const { return now_.load(); }
+    void advance(uint64_t ticks);
+
+    // Starts and stops the thread that turns wall time into ticks
+    void start();
+    void stop();
+
+    // Blocks until the clock reaches `tick`, `interrupted()` returns true, or `maxWait`
+    // passes; returns whether `tick` was reached. `interrupted` is checked with the clock's
+    // wait lock held, so whoever makes it true must call interruptWaiters() afterwards.
+    template <typename Interrupted>
+    bool waitUntil(uint64_t tick, std::chrono::microseconds maxWait, Interrupted interrupted);
+    void interruptWaiters();
+
+private:
+    void wallClockLoop();
+    std::chrono::microseconds nextWallClockWait() const;
+    void publishNextDeadline_unlocked();
+
+    std::atomic<uint64_t> now_{ 0 };
+
+    std::mutex waitMutex_;
+    std::condition_variable waitCv_;
+    std::multiset<uint64_t> deadlines_;
+    std::atomic<uint64_t> nextDeadline_{ NO_DEADLINE }; // Earliest of deadlines_
+
+    std::thread wallClockThread_;
+    std::mutex runMutex_;
+    std::condition_variable runCv_;
+    bool running_ = false;
+    bool deadlineMoved_ = false; // An earlier deadline arrived; the wall-clock thread's wait is too long
+};
+
+template <typename Interrupted>
+bool VirtualClock::waitUntil(uint64_t tick, std::chrono::microseconds maxWait, Interrupted interrupted) {
+    if (now() >= tick) return true;
+
+    std::unique_lock<std::mutex> lock(waitMutex_);
+    auto deadline = deadlines_.insert(tick);
+    publishNextDeadline_unlocked();
+    waitCv_.wait_for(lock, maxWait, [&]() { return now() >= tick || interrupted(); });
+    deadlines_.erase(deadline);
+    publishNextDeadline_unlocked();
+    return now() >= tick;
+}
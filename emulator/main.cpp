@@ -3,7 +3,7 @@
 #include "Process.h"
 #include "Core.h"
 #include "Scheduler.h" // Needs to be included since Console now creates Scheduler
-#include "GlobalState.h" // Global CPU ticks access
+#include "GlobalState.h" // Global CPU clock access
 
 int main() {
 